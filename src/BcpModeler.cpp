@@ -19,7 +19,7 @@
 
 BcpLpModel::BcpLpModel(BcpModeler* pModel):
 pModel_(pModel),nbCurrentColumnVarsBeforePricing_(pModel->getNbColumns()),
-lpIteration_(0), last_node(-1), heuristicHasBeenRun_(false)
+lpIteration_(0), last_node(-1), heuristicHasBeenRun_(false), stoppedByLagrangianBound_(false), pricingOptimal_(true)
 { }
 
 //Initialize the lp parameters and the OsiSolver
@@ -155,12 +155,13 @@ void BcpLpModel::printSummaryLine(const BCP_vec<BCP_var*>& vars){
 //         getLpProblemPointer()->node->true_lower_bound;
 
       if( vars.size() == 0 ){
-         fprintf(pFile,"BCP: %13s %5s | %10s %10s %10s | %8s %10s %12s %10s | %10s %5s %5s \n",
-            "Node", "Lvl", "BestUB", "RootLB", "BestLB","#It",  "Obj", "#Frac", "#Active", "ObjSP", "#SP", "#Col");
-         fprintf(pFile,"BCP: %5d / %5d %5d | %10.0f %10.2f %10.2f | %8s %10s %12s %10s | %10s %5s %5s \n",
+         fprintf(pFile,"BCP: %13s %5s | %10s %10s %10s | %8s %10s %12s %10s | %10s %5s %5s %7s %9s %6s %7s | %5s %8s %5s %5s \n",
+            "Node", "Lvl", "BestUB", "RootLB", "BestLB","#It",  "Obj", "#Frac", "#Active", "ObjSP", "#SP", "#Col", "LabKB", "#Labels", "Reuse%",
+            "ArcUpd%", "#CG", "PrTime", "#Misp", "#Dup");
+         fprintf(pFile,"BCP: %5d / %5d %5d | %10.0f %10.2f %10.2f | %8s %10s %12s %10s | %10s %5s %5s %7s %9s %6s %7s | %5s %8s %5s %5s \n",
             current_index(), pModel_->getTreeSize(), current_level(),
             pModel_->getBestUB(), pModel_->getRootLB(), pModel_->getBestLB(),
-            "-", "-", "-", "-", "-", "-", "-");
+            "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-", "-");
       }
 
       else{
@@ -179,11 +180,14 @@ void BcpLpModel::printSummaryLine(const BCP_vec<BCP_var*>& vars){
 
          int nbColGenerated = pModel_->getNbColumns() - nbCurrentColumnVarsBeforePricing_;
 
-         fprintf(pFile,"BCP: %5d / %5d %5d | %10.0f %10.2f %10.2f | %8d %10.2f %5d / %4d %10d | %10.2f %5d %5d  \n",
+         fprintf(pFile,"BCP: %5d / %5d %5d | %10.0f %10.2f %10.2f | %8d %10.2f %5d / %4d %10d | %10.2f %5d %5d %7d %9ld %6.1f %7.1f | %5d %8.2f %5d %5d \n",
             current_index(), pModel_->getTreeSize(), current_level(),
             pModel_->getBestUB(), pModel_->getRootLB(), pModel_->getBestLB(),
             lpIteration_, pModel_->getLastObj(), frac, non_zero, vars.size() - pModel_->getCoreVars().size(),
-            pModel_->getLastMinDualCost(), pModel_->getLastNbSubProblemsSolved(), nbColGenerated);
+            pModel_->getLastMinDualCost(), pModel_->getLastNbSubProblemsSolved(), nbColGenerated,
+            (int) (pModel_->getLastMaxLabelMemory() / 1024), pModel_->getLastNbLabels(), pModel_->getPricingCacheHitRate(),
+            pModel_->getArcCostUpdateRate(),
+            pModel_->getNodeNbPricings(), pModel_->getNodePricingTime(), pModel_->getNodeNbMisprices(), pModel_->getNodeNbDuplicates());
       }
    }
    if (!pModel_->logfile().empty()) fclose(pFile);
@@ -291,11 +295,21 @@ void BcpLpModel::generate_vars_in_lp(const BCP_lp_result& lpres,
 
    ++lpIteration_;
    pModel_->setLPSol(lpres, vars);
-   pModel_->pricing(0, before_fathom);
+   //the columns generated but not given to bcp yet (e.g. if the column generation of the previous node has been stopped
+   //by the lagrangian bound) will be added with the new ones
+   pModel_->setFirstNewColumn(nbCurrentColumnVarsBeforePricing_);
+   pricingOptimal_ = pModel_->pricing(0, before_fathom);
 
    /* Print a line summary of the solver state */
    printSummaryLine(vars);
 
+   //stop the column generation if the lagrangian bound proves that the node cannot improve the best upper bound,
+   //or if it has stopped improving: the node is then fathomed or branched with this bound
+   //(the new columns will be added in the next node)
+   stoppedByLagrangianBound_ = pModel_->isLagrangianBoundEnough() || pModel_->isLagrangianBoundPlateau();
+   if(stoppedByLagrangianBound_)
+      return;
+
    //check if new columns add been added since the last time
    //if there are some, add all of them in new_vars
    int size = pModel_->getNbColumns();
@@ -336,11 +350,25 @@ BCP_branching_decision BcpLpModel::select_branching_candidates(const BCP_lp_resu
 	if(local_var_pool.size() > 0)
 		return BCP_DoNotBranch;
 
+	//lower bound of the node: the lp value at the end of the column generation, or the lagrangian bound if it has
+	//been stopped before
+	double nodeLB = stoppedByLagrangianBound_ ? pModel_->getNodeLagrangianBound() : lpres.objval();
+	//the last pricing has not proven the lp value: keep the bound of the node (inherited from its parent), or its
+	//lagrangian bound if it is better
+	if(!stoppedByLagrangianBound_ && !pricingOptimal_){
+		nodeLB = getLpProblemPointer()->node->true_lower_bound;
+		if(pModel_->getNodeLagrangianBound() < LARGE_SCORE)
+			nodeLB = max(nodeLB, pModel_->getNodeLagrangianBound());
+		nodeLB = min(nodeLB, lpres.objval());
+	}
+	stoppedByLagrangianBound_ = false;
+	pricingOptimal_ = true;
+
 	//update node
-	pModel_->updateNodeLB(lpres.objval());
+	pModel_->updateNodeLB(nodeLB);
 
 	//update true_lower_bound, as we reach the end of the column generation
-	getLpProblemPointer()->node->true_lower_bound = lpres.objval();
+	getLpProblemPointer()->node->true_lower_bound = nodeLB;
 	heuristicHasBeenRun_ = false;
 
 	if(pModel_->is_solution_changed()) pModel_->setLPSol(lpres, vars);
@@ -356,7 +384,7 @@ BCP_branching_decision BcpLpModel::select_branching_candidates(const BCP_lp_resu
 		return BCP_DoNotBranch_Fathomed;
 
 	//fathom if greater than current upper bound
-	if(pModel_->getBestUB() - lpres.objval() < pModel_->getParameters().absoluteGap_ - EPSILON)
+	if(pModel_->getBestUB() - nodeLB < pModel_->getParameters().absoluteGap_ - EPSILON)
 		return BCP_DoNotBranch_Fathomed;
 
    //branching candidates: numberOfNursesByPosition_, rest on a day, ...
@@ -712,7 +740,10 @@ void BcpBranchingTree::init_new_phase(int phase, BCP_column_generation& colgen,
 BcpModeler::BcpModeler(const char* name):
    CoinModeler(), currentNode_(0), tree_size_(1), nb_nodes_last_incumbent_(0), diveDepth_(0), diveLenght_(LARGE_SCORE),
    primalValues_(0), dualValues_(0), reducedCosts_(0), lhsValues_(0),
-   best_lb_in_root(LARGE_SCORE), best_lb(LARGE_SCORE), lastNbSubProblemsSolved_(0), lastMinDualCost_(0)
+   best_lb_in_root(LARGE_SCORE), best_lb(LARGE_SCORE), lastNbSubProblemsSolved_(0), lastMinDualCost_(0), lastMaxLabelMemory_(0), lastNbLabels_(0),
+   pricingStatsNode_(0), nbPricingCacheHits_(0), nbPricingCacheLookups_(0),
+   nodeNbArcCostsUpdated_(0), nodeNbArcCostsSkipped_(0), nodeNbPricings_(0), nodeNbMisprices_(0), nodeNbDuplicates_(0), nodePricingTime_(0),
+   nodeLagrangianBound_(LARGE_SCORE), nbPricingsSinceLagrangianImprovement_(0)
 {
    //create the root
    pushBackNewNode();
@@ -748,6 +779,19 @@ void BcpModeler::reset() {
    best_lb = LARGE_SCORE;
    lastNbSubProblemsSolved_=0;
    lastMinDualCost_=0;
+   lastMaxLabelMemory_=0;
+   lastNbLabels_=0;
+   pricingStatsNode_=0;
+   nbPricingCacheHits_=0;
+   nbPricingCacheLookups_=0;
+   nodeNbArcCostsUpdated_=0;
+   nodeNbArcCostsSkipped_=0;
+   nodeNbPricings_=0;
+   nodeNbMisprices_=0;
+   nodeNbDuplicates_=0;
+   nodePricingTime_=0;
+   nodeLagrangianBound_=LARGE_SCORE;
+   nbPricingsSinceLagrangianImprovement_=0;
    solHasChanged_ = false;
 
    obj_history_.clear();
@@ -826,11 +870,14 @@ void BcpModeler::setLPSol(const BCP_lp_result& lpres, const BCP_vec<BCP_var*>&
    primalValues_.insert(primalValues_.end(), zeroArray, zeroArray+nbColVar);
    reducedCosts_.insert(reducedCosts_.end(), zeroArray, zeroArray+nbColVar);
    //loop through the variables and link the good columns together
+   //(they are the columns of the formulation of the current node)
+   columnsInNode_.assign(nbColVar, false);
    for(int i=nbCoreVar; i<vars.size(); ++i){
       BCP_var* var0 = vars[i];
       BcpColumn* var = dynamic_cast<BcpColumn*>(var0);
       primalValues_[var->getIndex()] = lpres.x()[i];
       reducedCosts_[var->getIndex()] = lpres.dj()[i];
+      columnsInNode_[var->getIndex()] = true;
    }
 
    if (zeroArray) free(zeroArray);
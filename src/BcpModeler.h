@@ -179,6 +179,9 @@ struct BcpNode{
    const CoinVar* pNumberOfNurses_;
    const double nursesLhs_, nursesRhs_;
 
+   //arcs of the rotation network of each nurse eliminated by reduced cost at this node (valid for the whole subtree)
+   map<const LiveNurse*, vector<int> > forbiddenArcs_;
+
 protected:
    double bestLB_;
    //highest gap between the bestLB_ and the computed bestLB_ of the children
@@ -232,6 +235,9 @@ public:
 
    double getDual(MyCons* cons, bool transformed = false);
 
+   //all the dual values of the last lp, indexed by the index of the constraints
+   const vector<double>& getDualValues() { return dualValues_; }
+
    /**************
     * Parameters *
     *************/
@@ -257,6 +263,15 @@ public:
 
    void setLPSol(const BCP_lp_result& lpres, const BCP_vec<BCP_var*>&  vars);
 
+   //true if the column is in the formulation of the current node (given to setLPSol), or if it has been generated
+   //since the last new columns given to bcp (it will be added to the formulation with the next ones)
+   inline bool isInCurrentNode(MyVar* var){
+      int index = ((CoinVar*) var)->getIndex();
+      return index >= firstNewColumn_ || index >= columnsInNode_.size() || columnsInNode_[index];
+   }
+
+   inline void setFirstNewColumn(int firstNewColumn){ firstNewColumn_ = firstNewColumn; }
+
    void addBcpSol(const BCP_solution* sol);
 
    bool loadBestSol();
@@ -279,6 +294,87 @@ public:
 
    inline double getLastMinDualCost(){ return lastMinDualCost_; }
 
+   inline void setLastMaxLabelMemory(size_t lastMaxLabelMemory){ lastMaxLabelMemory_ = lastMaxLabelMemory; }
+
+   inline size_t getLastMaxLabelMemory(){ return lastMaxLabelMemory_; }
+
+   inline void setLastNbLabels(long lastNbLabels){ lastNbLabels_ = lastNbLabels; }
+
+   inline long getLastNbLabels(){ return lastNbLabels_; }
+
+   //count the subproblems whose result has been reused among those priced in the current node
+   inline void addPricingCacheLookups(int nbHits, int nbLookups){
+      resetNodePricingStats();
+      nbPricingCacheHits_ += nbHits;
+      nbPricingCacheLookups_ += nbLookups;
+   }
+
+   //percentage of the subproblems whose result has been reused in the current node
+   inline double getPricingCacheHitRate(){ return nbPricingCacheLookups_ ? 100.0 * nbPricingCacheHits_ / nbPricingCacheLookups_ : 0; }
+
+   //count the arc costs updated / kept unchanged by the subproblems solved in the current node
+   inline void addArcCostUpdates(long nbUpdated, long nbSkipped){
+      resetNodePricingStats();
+      nodeNbArcCostsUpdated_ += nbUpdated;
+      nodeNbArcCostsSkipped_ += nbSkipped;
+   }
+
+   //percentage of the arc costs updated by the subproblems in the current node
+   inline double getArcCostUpdateRate(){
+      long nbArcCosts = nodeNbArcCostsUpdated_ + nodeNbArcCostsSkipped_;
+      return nbArcCosts ? 100.0 * nodeNbArcCostsUpdated_ / nbArcCosts : 0;
+   }
+
+   //count a pricing (one iteration of column generation) of the current node, its time and its number of mispricings
+   inline void addPricing(double time, int nbMisprices){
+      resetNodePricingStats();
+      ++nodeNbPricings_;
+      nodePricingTime_ += time;
+      nodeNbMisprices_ += nbMisprices;
+   }
+
+   inline int getNodeNbPricings(){ return nodeNbPricings_; }
+
+   inline double getNodePricingTime(){ return nodePricingTime_; }
+
+   inline int getNodeNbMisprices(){ return nodeNbMisprices_; }
+
+   //count the generated rotations that have been rejected in the current node as they were already columns
+   inline void addDuplicateColumns(int nbDuplicates){
+      resetNodePricingStats();
+      nodeNbDuplicates_ += nbDuplicates;
+   }
+
+   inline int getNodeNbDuplicates(){ return nodeNbDuplicates_; }
+
+   //track the best lagrangian bound of the current node (LARGE_SCORE if it has not been computed), and the number of
+   //pricings since it has last improved. Return true if the bound has improved
+   inline bool updateLagrangianBound(double lagrangianBound){
+      resetNodePricingStats();
+      if(lagrangianBound >= LARGE_SCORE)
+         return false;
+      if(nodeLagrangianBound_ >= LARGE_SCORE || lagrangianBound > nodeLagrangianBound_ + max(EPSILON, 1e-4 * fabs(nodeLagrangianBound_))){
+         nodeLagrangianBound_ = lagrangianBound;
+         nbPricingsSinceLagrangianImprovement_ = 0;
+         return true;
+      }
+      ++nbPricingsSinceLagrangianImprovement_;
+      return false;
+   }
+
+   inline double getNodeLagrangianBound(){ return nodeLagrangianBound_; }
+
+   //the column generation of the current node can be stopped if its lagrangian bound proves that it cannot improve
+   //the best upper bound, or if this bound has not improved for lagrangianPlateau_ pricings (then branch)
+   inline bool isLagrangianBoundEnough(){
+      return nodeLagrangianBound_ < LARGE_SCORE && getBestUB() - nodeLagrangianBound_ < parameters_.absoluteGap_ - EPSILON;
+   }
+
+   inline bool isLagrangianBoundPlateau(){
+      return nodeLagrangianBound_ < LARGE_SCORE && parameters_.lagrangianPlateau_ > 0
+            && nbPricingsSinceLagrangianImprovement_ >= parameters_.lagrangianPlateau_;
+   }
+
    inline double getLastObj(){ return obj_history_[obj_history_.size()-1]; }
 
    /*
@@ -334,6 +430,21 @@ public:
 //         cout << arcs[i]->name_ << " " << getVarValue(arcs[i]) << endl;
    }
 
+   inline void addForbiddenArcs(LiveNurse* pNurse, vector<int>& forbiddenArcs) {
+      //the root is included: its arcs are eliminated for the whole tree
+      for(BcpNode* node = currentNode_; node; node = node->pParent_){
+         map<const LiveNurse*, vector<int> >::iterator it = node->forbiddenArcs_.find(pNurse);
+         if(it != node->forbiddenArcs_.end())
+            forbiddenArcs.insert(forbiddenArcs.end(), it->second.begin(), it->second.end());
+      }
+   }
+
+   inline void storeForbiddenArcs(LiveNurse* pNurse, const vector<int>& forbiddenArcs) {
+      if(!currentNode_ || forbiddenArcs.empty()) return;
+      vector<int>& arcs = currentNode_->forbiddenArcs_[pNurse];
+      arcs.insert(arcs.end(), forbiddenArcs.begin(), forbiddenArcs.end());
+   }
+
    inline void setCurrentNode(const CoinTreeSiblings* s) {
       /* the current node of this siblings is already taken as processed */
       int nodeIndex = s->size() - s->toProcess() - 1;
@@ -429,6 +540,9 @@ protected:
    vector<double> obj_history_;
    vector<double> primalValues_, dualValues_, reducedCosts_, lhsValues_;
    bool solHasChanged_ = false; //reload solution ?
+   //columns in the formulation of the current node (indexed by their index), and first column not given to bcp yet
+   vector<bool> columnsInNode_;
+   int firstNewColumn_ = 0;
    //bcp branching cons
    vector<BcpBranchCons*> branchingCons_;
    //bcp solution
@@ -439,6 +553,38 @@ protected:
    int lastNbSubProblemsSolved_;
    //min dual cost for a rotation on the last iteration of column generation
    double lastMinDualCost_;
+   //max memory used by the labels of a sub problem on the last iteration of column generation (in bytes)
+   size_t lastMaxLabelMemory_;
+   //number of labels created by the sub problems on the last iteration of column generation
+   long lastNbLabels_;
+   //statistics of the pricing in the node pricingStatsNode_: number of sub problems whose result has been reused,
+   //number of sub problems priced, number of iterations of column generation, time spent in the pricing and number
+   //of mispricings due to the dual smoothing
+   BcpNode* pricingStatsNode_;
+   int nbPricingCacheHits_, nbPricingCacheLookups_;
+   long nodeNbArcCostsUpdated_, nodeNbArcCostsSkipped_;
+   int nodeNbPricings_, nodeNbMisprices_, nodeNbDuplicates_;
+   double nodePricingTime_;
+   //best lagrangian bound of the node pricingStatsNode_, and number of pricings since it has last improved
+   double nodeLagrangianBound_;
+   int nbPricingsSinceLagrangianImprovement_;
+
+   //reset the statistics of the pricing when the current node changes
+   inline void resetNodePricingStats(){
+      if(pricingStatsNode_ == currentNode_)
+         return;
+      pricingStatsNode_ = currentNode_;
+      nbPricingCacheHits_ = 0;
+      nbPricingCacheLookups_ = 0;
+      nodeNbArcCostsUpdated_ = 0;
+      nodeNbArcCostsSkipped_ = 0;
+      nodeNbPricings_ = 0;
+      nodeNbMisprices_ = 0;
+      nodeNbDuplicates_ = 0;
+      nodePricingTime_ = 0;
+      nodeLagrangianBound_ = LARGE_SCORE;
+      nbPricingsSinceLagrangianImprovement_ = 0;
+   }
 
    /* Parameters */
    //At every this many search tree node provide a single line info on the progress of the search tree.
@@ -652,6 +798,11 @@ protected:
    int last_node;
    //if heuristic has been run. To be sure to run the heuristic no more than one time per node
    bool heuristicHasBeenRun_;
+   //if the column generation of the node has been stopped by its lagrangian bound (the lp value is not a lower bound)
+   bool stoppedByLagrangianBound_;
+   //if the last pricing has proven that no column of negative reduced cost is missing (otherwise, the lp value is not
+   //a lower bound either, e.g. if all the rotations found were already columns of the node)
+   bool pricingOptimal_;
 
    //vars = are just the giver vars
    //cols is the vector where the new columns will be stored
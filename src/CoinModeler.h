@@ -63,6 +63,11 @@ struct CoinVar: public MyVar {
       coeffs_.push_back(coeff);
    }
 
+   void setRows(int nbRows, const int* indexRows, const double* coeffs){
+      indexRows_.assign(indexRows, indexRows+nbRows);
+      coeffs_.assign(coeffs, coeffs+nbRows);
+   }
+
    void toString(vector<CoinCons*>& cons) {
       cout << name_ << ":";
       for(int i=0; i<indexRows_.size(); ++i)
@@ -197,6 +202,27 @@ public:
       return 1;
    }
 
+   /*
+    * Add a block of new columns: the rows of each column are set at once
+    */
+
+   void createColumns(const MyColumnBlock& block, vector<MyVar*>& vars){
+      vector<int> indexRows(block.rows_.size());
+      for(int k=0; k<block.rows_.size(); ++k)
+         indexRows[k] = ((CoinCons*) block.rows_[k])->getIndex();
+
+      vars.reserve(vars.size() + block.size());
+      columnVars_.reserve(columnVars_.size() + block.size());
+      for(int j=0; j<block.size(); ++j){
+         MyVar* var;
+         createColumnVar(&var, block.names_[j].c_str(), block.costs_[j], block.dualCosts_[j], block.lbs_[j], block.ubs_[j],
+            block.types_[j], 0);
+         int start = block.starts_[j];
+         ((CoinVar*) var)->setRows(block.starts_[j+1]-start, &indexRows[start], &block.coeffs_[start]);
+         vars.push_back(var);
+      }
+   }
+
    /*
     * Build the CoinedPackMatrix corresponding to the problem
     * If justCore = true, add just the core variables
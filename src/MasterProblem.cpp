@@ -11,6 +11,8 @@
 //#include "ScipModeler.h"
 #include "RotationPricer.h"
 
+#include <boost/functional/hash.hpp>
+
 /* namespace usage */
 using namespace std;
 
@@ -35,6 +37,9 @@ void Rotation::computeCost(Scenario* pScenario, Preferences* pPreferences, int h
     ************************************************/
    //   double consShiftsCost_ , consDaysWorkedCost_, completeWeekendCost_, preferenceCost_ ;
 
+   //penalties of the consecutive sequences of the contract of the nurse
+   const PenaltyTable& penalties = pScenario->penaltyTable(pNurse_->pContract_);
+
    //if first day of the planning, check on the past, otherwise 0 (rest)
    int lastShift = (firstDay_==0) ? pNurse_->pStateIni_->shift_ : 0;
    //nbConsShift = number of consecutive shift
@@ -63,34 +68,24 @@ void Rotation::computeCost(Scenario* pScenario, Preferences* pPreferences, int h
     */
 
    // if the initial shift has already exceeded the max, substract now the cost that will be readd later
-   if( (firstDay_==0) && (lastShift>0) &&
-      (nbConsShifts > pScenario->maxConsShifts_[lastShift])){
-      consShiftsCost_ -= (nbConsShifts-pScenario->maxConsShifts_[lastShift])*WEIGHT_CONS_SHIFTS;
-   }
+   if( (firstDay_==0) && (lastShift>0) )
+      consShiftsCost_ -= penalties.consShiftExcessCost(lastShift, nbConsShifts);
 
    for(int k=firstDay_; k<firstDay_+length_; ++k){
-      if(lastShift == shifts_[k]){
+      if(lastShift == shift(k)){
          nbConsShifts ++;
          continue;
       }
-      if(lastShift > 0){
-         int diff = max(pScenario->minConsShifts_[lastShift] - nbConsShifts,
-            nbConsShifts-pScenario->maxConsShifts_[lastShift]);
-         if(diff>0) {
-            consShiftsCost_ += diff * WEIGHT_CONS_SHIFTS;
-         }
-      }
+      if(lastShift > 0)
+         consShiftsCost_ += penalties.consShiftCost(lastShift, nbConsShifts);
       //initialize nbConsShifts and lastShift
       nbConsShifts = 1;
-      lastShift = shifts_[k];
+      lastShift = shift(k);
    }
 
-   //compute consShiftsCost for the last shift
-   int diff = max((firstDay_+length_ == horizon) ? 0 : pScenario->minConsShifts_[lastShift] - nbConsShifts,
-      nbConsShifts-pScenario->maxConsShifts_[lastShift]);
-   if(diff>0) {
-      consShiftsCost_ += diff * WEIGHT_CONS_SHIFTS;
-   }
+   //compute consShiftsCost for the last shift (the minimum does not count if it finishes on last day)
+   consShiftsCost_ += (firstDay_+length_ == horizon) ? penalties.consShiftExcessCost(lastShift, nbConsShifts) :
+      penalties.consShiftCost(lastShift, nbConsShifts);
 
 
    /*
@@ -98,16 +93,12 @@ void Rotation::computeCost(Scenario* pScenario, Preferences* pPreferences, int h
     */
 
    // if already worked too much
-   double diffDays = nbConsDaysWorked - pNurse_->pContract_->maxConsDaysWork_;
-   consDaysWorkedCost_ = (diffDays > 0) ? - diffDays * WEIGHT_CONS_DAYS_WORK : 0 ;
+   consDaysWorkedCost_ = - penalties.consDaysWorkExcessCost(nbConsDaysWorked);
 
    nbConsDaysWorked += length_;
-   //check if nbConsDaysWorked < min, if finishes on last day, does not count
-   if(nbConsDaysWorked < pNurse_->minConsDaysWork() && firstDay_+length_ < horizon)
-      consDaysWorkedCost_ += (pNurse_->minConsDaysWork() - nbConsDaysWorked) * WEIGHT_CONS_DAYS_WORK;
-   //check if nbConsDaysWorked > max
-   else if(nbConsDaysWorked > pNurse_->maxConsDaysWork())
-      consDaysWorkedCost_ += (nbConsDaysWorked - pNurse_->maxConsDaysWork()) * WEIGHT_CONS_DAYS_WORK;
+   //check if nbConsDaysWorked is outside [min,max], if finishes on last day, the min does not count
+   consDaysWorkedCost_ += (firstDay_+length_ < horizon) ? penalties.consDaysWorkCost(nbConsDaysWorked) :
+      penalties.consDaysWorkExcessCost(nbConsDaysWorked);
 
    /*
     * Compute completeWeekendCost
@@ -126,17 +117,15 @@ void Rotation::computeCost(Scenario* pScenario, Preferences* pPreferences, int h
     */
 
    for(int k=firstDay_; k<firstDay_+length_; ++k)
-      if(pPreferences->wantsTheShiftOff(pNurse_->id_, k, shifts_[k]))
+      if(pPreferences->wantsTheShiftOff(pNurse_->id_, k, shift(k)))
          preferenceCost_ += WEIGHT_PREFERENCES;
 
    /*
     * Compute initial resting cost
     */
 
-   if(firstDay_==0 && pNurse_->pStateIni_->shift_==0){
-      int diff = pNurse_->minConsDaysOff() - pNurse_->pStateIni_->consDaysOff_;
-      initRestCost_ = (diff > 0) ? diff*WEIGHT_CONS_DAYS_OFF : 0;
-   }
+   if(firstDay_==0 && pNurse_->pStateIni_->shift_==0)
+      initRestCost_ = penalties.consDaysOffShortageCost(pNurse_->pStateIni_->consDaysOff_);
 
    /*
     * Compute the sum of the cost and stores it in cost_
@@ -168,7 +157,7 @@ void Rotation::computeDualCost(DualCosts& costs){
 
       /* Working dual cost */
       for(int k=firstDay_; k<firstDay_+length_; ++k)
-         dualCost -= costs.dayShiftWorkCost(k, shifts_[k]-1);
+         dualCost -= costs.dayShiftWorkCost(k, shift(k)-1);
       /* Start working dual cost */
       dualCost -= costs.startWorkCost(firstDay_);
       /* Stop working dual cost */
@@ -197,7 +186,7 @@ void Rotation::computeDualCost(DualCosts& costs){
     	  cout << "#       | Initial rest      : " << initRestCost_ << endl;
 
     	  for(int k=firstDay_; k<firstDay_+length_; ++k)
-    		  cout << "#   | Work day-shift: - " << costs.dayShiftWorkCost(k, shifts_[k]-1) << endl;
+    		  cout << "#   | Work day-shift: - " << costs.dayShiftWorkCost(k, shift(k)-1) << endl;
     	  cout << "#   | Start work    : - " << costs.startWorkCost(firstDay_) << endl;
     	  cout << "#   | Finish Work   : - " << costs.endWorkCost(firstDay_+length_-1) << endl;
     	  if(Tools::isSunday(firstDay_))
@@ -214,6 +203,21 @@ void Rotation::computeDualCost(DualCosts& costs){
       }
 }
 
+//Hash of the first day and of the shifts
+//
+size_t Rotation::signature() const{
+   size_t hash = 0;
+   boost::hash_combine(hash, firstDay_);
+   boost::hash_range(hash, shifts_.begin(), shifts_.end());
+   return hash;
+}
+
+//True if the rotations have the same first day and the same shifts
+//
+bool Rotation::isSameAs(const Rotation& rotation) const{
+   return firstDay_ == rotation.firstDay_ && shifts_ == rotation.shifts_;
+}
+
 //Compare rotations on index
 //
 bool Rotation::compareId(const Rotation& rot1, const Rotation& rot2){
@@ -251,7 +255,7 @@ MasterProblem::MasterProblem(Scenario* pScenario, Demand* pDemand,
    Solver(pScenario, pDemand, pPreferences, pInitState), PrintSolution(),
    solverType_(solverType), pModel_(0), pPricer_(0), pRule_(0),
    positionsPerSkill_(pScenario->nbSkills_), skillsPerPosition_(pScenario->nbPositions()),
-   rotations_(pScenario->nbNurses_), restsPerDay_(pScenario->nbNurses_),
+   rotations_(pScenario->nbNurses_), rotationSignatures_(pScenario->nbNurses_), restsPerDay_(pScenario->nbNurses_),
 
    columnVars_(pScenario->nbNurses_), restingVars_(pScenario->nbNurses_), longRestingVars_(pScenario->nbNurses_),
    minWorkedDaysVars_(pScenario->nbNurses_), maxWorkedDaysVars_(pScenario->nbNurses_), maxWorkedWeekendVars_(pScenario->nbNurses_),
@@ -504,15 +508,15 @@ void MasterProblem::storeSolution(){
             for(int k=p.second.firstDay_; k<p.second.firstDay_+p.second.length_; ++k){
                bool assigned = false;
                for(int sk=0; sk<pScenario_->nbSkills_; ++sk)
-                  if(skillsAllocation[k][p.second.shifts_[k]-1][sk][pNurse->pPosition_->id_] > EPSILON){
-                     pNurse->roster_.assignTask(k,p.second.shifts_[k],sk);
-                     skillsAllocation[k][p.second.shifts_[k]-1][sk][pNurse->pPosition_->id_] --;
+                  if(skillsAllocation[k][p.second.shift(k)-1][sk][pNurse->pPosition_->id_] > EPSILON){
+                     pNurse->roster_.assignTask(k,p.second.shift(k),sk);
+                     skillsAllocation[k][p.second.shift(k)-1][sk][pNurse->pPosition_->id_] --;
                      assigned = true;
                      break;
                   }
                if(!assigned){
                   char error[255];
-                  sprintf(error, "No skill found for Nurse %d on day %d on shift %d", pNurse->id_, k, p.second.shifts_[k]);
+                  sprintf(error, "No skill found for Nurse %d on day %d on shift %d", pNurse->id_, k, p.second.shift(k));
                   Tools::throwError((const char*) error);
                }
             }
@@ -545,31 +549,80 @@ void MasterProblem::save(vector<int>& weekIndices, string outdir){
 
 //build the variable of the rotation as well as all the affected constraints with their coefficients
 //if s=-1, the nurse i works on all shifts
-void MasterProblem::addRotation(Rotation& rotation, char* baseName){
+bool MasterProblem::addRotation(Rotation& rotation, char* baseName){
+	if(!addPendingRotation(rotation, baseName))
+		return false;
+	createPendingRotations();
+	return true;
+}
+
+//queue a new rotation if it is not already a column of the current node (or queued) for the nurse
+bool MasterProblem::addPendingRotation(Rotation& rotation, char* baseName){
 	//nurse index
 	int i = rotation.pNurse_->id_;
 
-	//Column var, its name, and affected constraints with their coefficients
-	MyVar* var;
+	//reject the rotation if it is already a column of the current node for the nurse
+	//(a column of another subtree is not in the formulation of the node: it is added again)
+	size_t signature = rotation.signature();
+	auto range = rotationSignatures_[i].equal_range(signature);
+	for(auto it = range.first; it != range.second; ++it)
+		if(rotations_[i].at(it->second).isSameAs(rotation) && pModel_->isInCurrentNode(it->second))
+			return false;
+	for(int p=0; p<pendingRotations_.size(); ++p)
+		if(pendingSignatures_[p] == signature && pendingRotations_[p].first.pNurse_ == rotation.pNurse_
+			&& pendingRotations_[p].first.isSameAs(rotation))
+			return false;
+
+	pendingRotations_.push_back(pair<Rotation, char*>(rotation, baseName));
+	pendingSignatures_.push_back(signature);
+	return true;
+}
+
+//create the columns of all the queued rotations in a single block
+void MasterProblem::createPendingRotations(){
+	if(pendingRotations_.empty())
+		return;
+
+	//Block of columns, their names, and affected constraints with their coefficients (reused for each rotation)
+	MyColumnBlock block;
 	char name[255];
 	vector<MyCons*> cons;
 	vector<double> coeffs;
-
-	/* Rotation constraints */
-	addRotationConsToCol(cons, coeffs, i, rotation.firstDay_, true, false);
-	addRotationConsToCol(cons, coeffs, i, rotation.firstDay_+rotation.length_-1, false, true);
-
-	/* Min/Max constraints */
-	int nbWeekends = Tools::containsWeekend(rotation.firstDay_, rotation.firstDay_+rotation.length_-1);
-	addMinMaxConsToCol(cons, coeffs, i, rotation.length_, nbWeekends);
-
-	/* Skills coverage constraints */
-	for(int k=rotation.firstDay_; k<rotation.firstDay_+rotation.length_; ++k)
-		addSkillsCoverageConsToCol(cons, coeffs, i, k, rotation.shifts_[k]);
-
-	sprintf(name, "%s_N%d_%d",baseName , i, rotations_[i].size());
-	pModel_->createIntColumn(&var, name, rotation.cost_, rotation.dualCost_, cons, coeffs);
-	rotations_[i].insert(pair<MyVar*,Rotation>(var, rotation));
+	vector<int> nbPendingRotations(pScenario_->nbNurses_, 0);
+
+	for(pair<Rotation, char*>& p: pendingRotations_){
+		Rotation& rotation = p.first;
+		int i = rotation.pNurse_->id_;
+		cons.clear();
+		coeffs.clear();
+
+		/* Rotation constraints */
+		addRotationConsToCol(cons, coeffs, i, rotation.firstDay_, true, false);
+		addRotationConsToCol(cons, coeffs, i, rotation.firstDay_+rotation.length_-1, false, true);
+
+		/* Min/Max constraints */
+		int nbWeekends = Tools::containsWeekend(rotation.firstDay_, rotation.firstDay_+rotation.length_-1);
+		addMinMaxConsToCol(cons, coeffs, i, rotation.length_, nbWeekends);
+
+		/* Skills coverage constraints */
+		for(int k=rotation.firstDay_; k<rotation.firstDay_+rotation.length_; ++k)
+			addSkillsCoverageConsToCol(cons, coeffs, i, k, rotation.shift(k));
+
+		sprintf(name, "%s_N%d_%d", p.second, i, rotations_[i].size() + nbPendingRotations[i]++);
+		block.addColumn(name, rotation.cost_, rotation.dualCost_, VARTYPE_INTEGER);
+		for(int c=0; c<cons.size(); ++c)
+			block.addCoef(cons[c], coeffs[c]);
+	}
+
+	vector<MyVar*> vars;
+	pModel_->createColumns(block, vars);
+	for(int p=0; p<pendingRotations_.size(); ++p){
+		int i = pendingRotations_[p].first.pNurse_->id_;
+		rotations_[i].insert(pair<MyVar*,Rotation>(vars[p], pendingRotations_[p].first));
+		rotationSignatures_[i].insert(pair<size_t,MyVar*>(pendingSignatures_[p], vars[p]));
+	}
+	pendingRotations_.clear();
+	pendingSignatures_.clear();
 }
 
 /*
@@ -585,6 +638,10 @@ void MasterProblem::buildRotationCons(){
       //=true if we have to compute a cost for resting days exceeding the maximum allowed
       //=false otherwise
       bool const maxRest = (maxConsDaysOff < pDemand_->nbDays_ + initConsDaysOff);
+      //penalties of the consecutive days off of the contract
+      const PenaltyTable& penalties = pScenario_->penaltyTable(theLiveNurses_[i]->pContract_);
+      //cost of one more day of rest after the maximum
+      double const extraRestCost = (maxRest) ? penalties.consDaysOffCost(maxConsDaysOff+1) - penalties.consDaysOffCost(maxConsDaysOff) : 0;
       //number of long resting arcs as function of maxRest
       int const nbLongRestingArcs((maxRest) ? maxConsDaysOff : minConsDaysOff);
       //first day when a rest arc exists =
@@ -613,8 +670,6 @@ void MasterProblem::buildRotationCons(){
          if(k==0){
             //number of min long resting arcs
             int nbMinRestArcs( max(0, minConsDaysOff - initConsDaysOff) );
-            //initialize cost
-            int cost (nbMinRestArcs * WEIGHT_CONS_DAYS_OFF);
             Rotation rot = computeInitStateRotation(theLiveNurses_[i]);
 
             //initialize vectors
@@ -622,10 +677,11 @@ void MasterProblem::buildRotationCons(){
             vector<MyVar*> longRestingVars3_0(indexStartRestArc);
 
             //create minRest arcs
+            //(the rest continues the days off of the initial state)
             for(int l=1; l<=nbMinRestArcs; ++l){
-               cost -= WEIGHT_CONS_DAYS_OFF;
                sprintf(name, "longRestingVars_N%d_%d_%d", i, 0, l);
-               pModel_->createPositiveVar(&longRestingVars3_0[l-1], name, cost+rot.cost_);
+               pModel_->createPositiveVar(&longRestingVars3_0[l-1], name,
+                  penalties.consDaysOffShortageCost(initConsDaysOff+l)+rot.cost_);
                rotations_[i].insert(pair<MyVar*,Rotation>(longRestingVars3_0[l-1], rot));
                //add this resting arc for each day of rest
                for(int k1=0; k1<l; ++k1)
@@ -647,7 +703,7 @@ void MasterProblem::buildRotationCons(){
             //create the only resting arc (same as a short resting arcs)
             if(firstRestArc == 0){
                sprintf(name, "restingVars_N%d_%d_%d", i, 0, 1);
-               pModel_->createPositiveVar(&longRestingVars3_0[0], name, (maxRest) ? WEIGHT_CONS_DAYS_OFF+rot.cost_ : rot.cost_);
+               pModel_->createPositiveVar(&longRestingVars3_0[0], name, extraRestCost+rot.cost_);
                rotations_[i].insert(pair<MyVar*,Rotation>(longRestingVars3_0[0], rot));
                //add this resting arc for the first day of rest
                restsPerDay2[0].push_back(longRestingVars3_0[0]);
@@ -661,23 +717,18 @@ void MasterProblem::buildRotationCons(){
          else{
             //number of long resting arcs = min(nbLongRestingArcs, number of possible long resting arcs)
             int nbLongRestingArcs2( min(nbLongRestingArcs, pDemand_->nbDays_-k) );
-            //initialize cost
-            //if the arc finishes the last day, the cost is 0. Indeed it will be computed on the next planning
-            int cost = minConsDaysOff * WEIGHT_CONS_DAYS_OFF;
-
             //initialize vectors
             vector<MyVar*> longRestingVars3(nbLongRestingArcs2);
 
             //create minRest arcs
             for(int l=1; l<=minConsDaysOff; ++l){
                bool doBreak = false;
-               cost -= WEIGHT_CONS_DAYS_OFF;
                sprintf(name, "longRestingVars_N%d_%d_%d", i, k, k+l);
                //if arc ends before the last day: normal cost
                if(l < pDemand_->nbDays_-k)
-                  pModel_->createPositiveVar(&longRestingVars3[l-1], name, cost);
+                  pModel_->createPositiveVar(&longRestingVars3[l-1], name, penalties.consDaysOffShortageCost(l));
                //otherwise, arc finishes on last day
-               //so: cost=0 and we break the loop
+               //so: cost=0 (it will be computed on the next planning) and we break the loop
                else{
                   pModel_->createPositiveVar(&longRestingVars3[l-1], name, 0);
                   doBreak = true;
@@ -708,7 +759,7 @@ void MasterProblem::buildRotationCons(){
           *****************************************/
          if(k>=indexStartRestArc){
             sprintf(name, "restingVars_N%d_%d_%d", i, k, k+1);
-            pModel_->createPositiveVar(&restingVars2[k-indexStartRestArc], name, (maxRest) ? WEIGHT_CONS_DAYS_OFF : 0);
+            pModel_->createPositiveVar(&restingVars2[k-indexStartRestArc], name, extraRestCost);
             //add this resting arc for this day of rest
             restsPerDay2[k].push_back(restingVars2[k-indexStartRestArc]);
          }
@@ -1215,13 +1266,9 @@ Rotation MasterProblem::computeInitStateRotation(LiveNurse* pNurse){
    //compute cost for previous cons worked shifts and days
    int lastShift = pNurse->pStateIni_->shift_;
    if(lastShift>0){
-      int nbConsWorkedDays = pNurse->pStateIni_->consDaysWorked_;
-      int diff = pNurse->minConsDaysWork() - nbConsWorkedDays;
-      rot.consDaysWorkedCost_ += (diff>0) ? diff*WEIGHT_CONS_DAYS_WORK : 0;
-
-      int nbConsShifts = pNurse->pStateIni_->consShifts_;
-      int diff2 = pScenario_->minConsShifts_[lastShift] - nbConsShifts;
-      rot.consShiftsCost_ += (diff2>0) ? diff2*WEIGHT_CONS_SHIFTS : 0;
+      const PenaltyTable& penalties = pScenario_->penaltyTable(pNurse->pContract_);
+      rot.consDaysWorkedCost_ += penalties.consDaysWorkShortageCost(pNurse->pStateIni_->consDaysWorked_);
+      rot.consShiftsCost_ += penalties.consShiftShortageCost(lastShift, pNurse->pStateIni_->consShifts_);
    }
    rot.cost_ = rot.consDaysWorkedCost_ + rot.consShiftsCost_;
 
@@ -14,39 +14,90 @@
 /* Tools include */
 #include "MyTools.h"
 
+#include <atomic>
+#include <unordered_map>
+#include <boost/container/small_vector.hpp>
+
 /* My includes */
 #include "Nurse.h"
 #include "Modeler.h"
 
 //-----------------------------------------------------------------------------
 //
-//  S t r u c t   R o t a t i o n
+//  S t r u c t   D u a l S n a p s h o t
 //
-//  A rotation is a set of shifts for a set of consecutive days.
-//  It has a cost and a dual cost (tbd).
+//  Dual values of the master used by the subproblems, copied once per pricing
+//  round in flat arrays. The coverage duals are stored once per position and
+//  shared by all the nurses of this position.
 //
 //-----------------------------------------------------------------------------
-enum CostType {TOTAL_COST, CONS_SHIFTS_COST, CONS_WORKED_DAYS_COST, COMPLETE_WEEKEND_COST, PREFERENCE_COST, INIT_REST_COST};
+struct DualSnapshot{
+public:
+
+   DualSnapshot(): nbDays_(0), nbShifts_(0) {}
+
+   // Resize the arrays (nbShifts is the number of worked shifts)
+   //
+   void init(int nbDays, int nbShifts, int nbPositions, int nbNurses){
+      nbDays_ = nbDays;
+      nbShifts_ = nbShifts;
+      coverageDuals_.assign(nbPositions*nbDays*nbShifts, 0);
+      workDuals_.assign(nbNurses, 0);
+      startWorkDuals_.assign(nbNurses*nbDays, 0);
+      endWorkDuals_.assign(nbNurses*nbDays, 0);
+      workedWeekendDuals_.assign(nbNurses, 0);
+   }
+
+   // GETTERS (first value of the block of a position or of a nurse)
+   //
+   inline const double* coverageDuals(int position) const {return &coverageDuals_[position*nbDays_*nbShifts_];}
+   inline const double* startWorkDuals(int nurse) const {return &startWorkDuals_[nurse*nbDays_];}
+   inline const double* endWorkDuals(int nurse) const {return &endWorkDuals_[nurse*nbDays_];}
 
+   int nbDays_, nbShifts_;
+
+   // Indexed by : (position, day, shift) !! 0 = shift 1 !!
+   vector<double> coverageDuals_;
+
+   // Indexed by : nurse. Duals of the min/max worked days constraints, paid for each worked day
+   vector<double> workDuals_;
+
+   // Indexed by : (nurse, day)
+   vector<double> startWorkDuals_, endWorkDuals_;
+
+   // Indexed by : nurse
+   vector<double> workedWeekendDuals_;
+
+};
+
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   D u a l C o s t s
+//
+//  View over the dual costs of a nurse: nothing is copied, the arrays
+//  must outlive the view.
+//
+//-----------------------------------------------------------------------------
 struct DualCosts{
 public:
 
-   DualCosts(vector< vector<double> > & workCosts, vector<double> & startWorkCosts, vector<double> & endWorkCosts, double workedWeekendCost, bool doNotCopy = true):
-      workCosts_(workCosts), startWorkCosts_(startWorkCosts), endWorkCosts_(endWorkCosts), workedWeekendCost_(workedWeekendCost) {
-
-	   if(!doNotCopy){
-		   workCosts_.clear();
-		   workCosts_ = Tools::appendVectors(workCosts_, workCosts);
-		   startWorkCosts_.clear();
-		   startWorkCosts_ = Tools::appendVectors(startWorkCosts_, startWorkCosts);
-		   endWorkCosts_.clear();
-		   endWorkCosts_ = Tools::appendVectors(endWorkCosts_, endWorkCosts);
-	   }
-   }
+   // The cost of (day, shift) is workCosts[day*nbShifts+shift] + workCostOffset
+   //
+   DualCosts(const double* workCosts, int nbShifts, double workCostOffset, const double* startWorkCosts,
+         const double* endWorkCosts, double workedWeekendCost):
+      workCosts_(workCosts), nbShifts_(nbShifts), workCostOffset_(workCostOffset),
+      startWorkCosts_(startWorkCosts), endWorkCosts_(endWorkCosts), workedWeekendCost_(workedWeekendCost) {}
+
+   // Duals of a nurse in a snapshot
+   //
+   DualCosts(const DualSnapshot& snapshot, int nurse, int position):
+      workCosts_(snapshot.coverageDuals(position)), nbShifts_(snapshot.nbShifts_), workCostOffset_(snapshot.workDuals_[nurse]),
+      startWorkCosts_(snapshot.startWorkDuals(nurse)), endWorkCosts_(snapshot.endWorkDuals(nurse)),
+      workedWeekendCost_(snapshot.workedWeekendDuals_[nurse]) {}
 
    // GETTERS
    //
-   inline double dayShiftWorkCost(int day, int shift){return (workCosts_[day][shift]);}
+   inline double dayShiftWorkCost(int day, int shift){return (workCosts_[day*nbShifts_+shift] + workCostOffset_);}
    inline double startWorkCost(int day){return (startWorkCosts_[day]);}
    inline double endWorkCost(int day){return (endWorkCosts_[day]);}
    inline double workedWeekendCost(){return workedWeekendCost_;}
@@ -55,42 +106,54 @@ public:
 protected:
 
    // Indexed by : (day, shift) !! 0 = shift 1 !!
-    vector< vector<double> > & workCosts_;
+   const double* workCosts_;
+   int nbShifts_;
+
+   // Added to all the work costs
+   double workCostOffset_;
 
-    // Indexed by : day
-    vector<double> & startWorkCosts_;
+   // Indexed by : day
+   const double* startWorkCosts_;
 
-    // Indexed by : day
-    vector<double> & endWorkCosts_;
+   // Indexed by : day
+   const double* endWorkCosts_;
 
-    // Reduced cost of the weekends
-    double workedWeekendCost_;
+   // Reduced cost of the weekends
+   double workedWeekendCost_;
 
 };
 
 
+//-----------------------------------------------------------------------------
+//
+//  S t r u c t   R o t a t i o n
+//
+//  A rotation is a set of shifts for a set of consecutive days.
+//  It has a cost and a dual cost (tbd).
+//
+//-----------------------------------------------------------------------------
+enum CostType {TOTAL_COST, CONS_SHIFTS_COST, CONS_WORKED_DAYS_COST, COMPLETE_WEEKEND_COST, PREFERENCE_COST, INIT_REST_COST};
+
 struct Rotation {
 
    // Specific constructors and destructors
    //
-   Rotation(map<int,int> shifts, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
-      shifts_(shifts), pNurse_(nurse), cost_(cost),id_(s_count),
+   //the days of the map must be consecutive
+   Rotation(const map<int,int>& shifts, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
+      pNurse_(nurse), cost_(cost),id_(s_count),
       consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
-      dualCost_(dualCost), length_(shifts.size())
+      dualCost_(dualCost), firstDay_(shifts.empty() ? 999 : shifts.begin()->first), length_(shifts.size())
    {
       ++s_count;
-      firstDay_ = 999;
-      for(map<int,int>::iterator itS = shifts.begin(); itS != shifts.end(); ++itS)
-         if(itS->first < firstDay_) firstDay_ = itS->first;
+      for(const pair<int,int>& p: shifts) shifts_.push_back(p.second);
    };
 
-   Rotation(int firstDay, vector<int> shiftSuccession, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
+   Rotation(int firstDay, const vector<int>& shiftSuccession, LiveNurse* nurse = NULL, double cost = DBL_MAX, double dualCost = DBL_MAX) :
       pNurse_(nurse), cost_(cost),id_(s_count),
       consShiftsCost_(0), consDaysWorkedCost_(0), completeWeekendCost_(0), preferenceCost_(0), initRestCost_(0),
-      dualCost_(dualCost), firstDay_(firstDay), length_(shiftSuccession.size())
+      dualCost_(dualCost), shifts_(shiftSuccession.begin(), shiftSuccession.end()), firstDay_(firstDay), length_(shiftSuccession.size())
    {
       ++s_count;
-      for(int k=0; k<shiftSuccession.size(); k++) shifts_.insert(pair<int,int>( (firstDay+k) , shiftSuccession[k] ));
    }
 
    Rotation(Rotation& rotation, LiveNurse* pNurse) :
@@ -107,9 +170,9 @@ struct Rotation {
 
    ~Rotation(){};
 
-   //count rotations
+   //count rotations (rotations may be created by several pricing threads)
    //
-   static unsigned int s_count;
+   static std::atomic<unsigned int> s_count;
 
    //Id of the rotation
    //
@@ -128,9 +191,9 @@ struct Rotation {
    //
    double dualCost_;
 
-   // Shifts to be performed
+   // Shifts to be performed from the first day (stored inline up to 16 days)
    //
-   map<int,int> shifts_;
+   boost::container::small_vector<int,16> shifts_;
 
    // First worked day
    //
@@ -140,6 +203,10 @@ struct Rotation {
    //
    int length_;
 
+   // Shift performed on a day of the rotation
+   //
+   inline int shift(int day) const { return shifts_[day-firstDay_]; }
+
    //Compute the cost of a rotation
    //
    void computeCost(Scenario* pScenario, Preferences* pPreferences, int horizon);
@@ -153,8 +220,8 @@ struct Rotation {
       std::cout << "#   | ROTATION: N=" << pNurse_->id_ << "  cost=" << cost_ << "  dualCost=" << dualCost_ << "  firstDay=" << firstDay_ << "  length=" << length_ << std::endl;
       std::cout << "#               |";
       vector<int> allTasks (nbDays);
-      for(map<int,int>::iterator itTask = shifts_.begin(); itTask != shifts_.end(); ++itTask)
-         allTasks[itTask->first] = itTask->second;
+      for(int k=firstDay_; k<firstDay_+length_; ++k)
+         allTasks[k] = shift(k);
       for(int i=0; i<allTasks.size(); i++){
          if(allTasks[i] < 1) std::cout << " |";
          else std::cout << allTasks[i] << "|";
@@ -162,6 +229,14 @@ struct Rotation {
       std::cout << std::endl;
    }
 
+   //Hash of the first day and of the shifts (identical for duplicated rotations)
+   //
+   size_t signature() const;
+
+   //True if the rotations have the same first day and the same shifts
+   //
+   bool isSameAs(const Rotation& rotation) const;
+
    //Compare rotations on index
    //
    static bool compareId(const Rotation& rot1, const Rotation& rot2);
@@ -243,6 +318,9 @@ private:
    MySolverType solverType_; //which solver is used
 
    vector< map<MyVar*, Rotation> > rotations_;//stores the variables and the rotations for each nurse
+   vector< unordered_multimap<size_t, MyVar*> > rotationSignatures_;//index of the columns of rotations_ by signature for each nurse (rejects the duplicates of the columns of the current node)
+   vector< pair<Rotation, char*> > pendingRotations_;//rotations waiting for their column, with their base name
+   vector<size_t> pendingSignatures_;//signatures of the pending rotations
    vector< vector< vector<MyVar*> > > restsPerDay_; //stores all the arcs that are resting on a day for each nurse
 
    /*
@@ -328,7 +406,13 @@ private:
    //add the correct constraints and coefficients for the nurse i working on a rotation
    //if s=-1, the nurse works on all shifts
    //store the rotation in rotations_
-   void addRotation(Rotation& rotation, char* baseName);
+   //return false (and do not add it) if the same rotation is already a column of the current node for the nurse
+   bool addRotation(Rotation& rotation, char* baseName);
+
+   //queue a new rotation (rejected as in addRotation if it is a duplicate): the columns of all the queued rotations
+   //are created at once, in a single block, by createPendingRotations
+   bool addPendingRotation(Rotation& rotation, char* baseName);
+   void createPendingRotations();
 
    //compute and add the last rotation finishing on the day just before the first one
    Rotation computeInitStateRotation(LiveNurse* pNurse);
@@ -128,6 +128,43 @@ protected:
    double rhs_; //rihgt hand side == upper bound
 };
 
+/*
+ * Block of new columns in CSC format:
+ *    the non-zero coefficients of the column j are coeffs_[starts_[j]] ... coeffs_[starts_[j+1]-1]
+ *    in the rows rows_[starts_[j]] ... rows_[starts_[j+1]-1]
+ */
+struct MyColumnBlock{
+   MyColumnBlock(): starts_(1, 0) { }
+
+   //add a new column: its coefficients have to be added just after
+   void addColumn(const char* name, double cost, double dualCost, VarType type, double lb = 0, double ub = DBL_MAX){
+      names_.push_back(name);
+      costs_.push_back(cost);
+      dualCosts_.push_back(dualCost);
+      types_.push_back(type);
+      lbs_.push_back(lb);
+      ubs_.push_back(ub);
+      starts_.push_back(starts_.back());
+   }
+
+   //add a coefficient to the last column
+   void addCoef(MyCons* cons, double coeff){
+      rows_.push_back(cons);
+      coeffs_.push_back(coeff);
+      ++starts_.back();
+   }
+
+   int size() const { return names_.size(); }
+
+   vector<string> names_;
+   vector<double> costs_, dualCosts_;
+   vector<VarType> types_;
+   vector<double> lbs_, ubs_;
+   vector<int> starts_;
+   vector<MyCons*> rows_;
+   vector<double> coeffs_;
+};
+
 /*
  * My pricer
  */
@@ -210,6 +247,15 @@ public:
 
    virtual void addForbidenShifts(LiveNurse* pNurse, set<pair<int,int> >& forbidenShifts) { }
 
+   //arcs of the rotation network of the nurse eliminated by reduced cost in the current node and its ancestors
+   virtual void addForbiddenArcs(LiveNurse* pNurse, vector<int>& forbiddenArcs) { }
+
+   //store arcs of the rotation network of the nurse eliminated by reduced cost in the current node (valid for its subtree)
+   virtual void storeForbiddenArcs(LiveNurse* pNurse, const vector<int>& forbiddenArcs) { }
+
+   //true if the column belongs to the formulation of the current node (all the columns if there is no branching tree)
+   virtual bool isInCurrentNode(MyVar* var) { return true; }
+
 
    /*
     * Class methods for pricer and branching rule
@@ -371,6 +417,13 @@ public:
       createColumn(var, var_name, objCoeff, dualObj, VARTYPE_INTEGER, cons, coeffs, transformed, score);
    }
 
+   /*
+    * Add a block of new columns to the problem
+    * vars receives the new variables in the order of the block
+    */
+
+   virtual void createColumns(const MyColumnBlock& block, vector<MyVar*>& vars)=0;
+
    /*
     * get the primal values
     */
@@ -28,6 +28,8 @@ std::map<std::string, WeightStrategy> stringToWeightStrategy =
    boost::assign::map_list_of("MAX", MAX)("MEAN", MEAN)("RANDOMMEANMAX",RANDOMMEANMAX)("BOUNDRATIO",BOUNDRATIO)("NO_STRAT",NO_STRAT);
 std::map<std::string, RankingStrategy> stringToRankingStrategy =
    boost::assign::map_list_of("SCORE", RK_SCORE)("MEAN", RK_MEAN);
+std::map<std::string, SPPRCAlgorithm> stringToSPPRCAlgorithm =
+   boost::assign::map_list_of("BOOST", SPPRC_BOOST)("DAY_BUCKETS", SPPRC_DAY_BUCKETS)("BIDIRECTIONAL", SPPRC_BIDIRECTIONAL);
 
 
 //--------------------------------------------------------------------------
@@ -645,6 +647,23 @@ string ReadWrite::readSolverOptions(string strOptionFile, SolverParam& options)
 		if(!strcmp(title.c_str(), "stopAfterXSolution")){
 			file >> options.stopAfterXSolution_;
 		}
+		if(!strcmp(title.c_str(), "nbPricingThreads")){
+			file >> options.nbPricingThreads_;
+		}
+		if(!strcmp(title.c_str(), "spprcLabelBudget")){
+			file >> options.spprcLabelBudget_;
+		}
+		if(!strcmp(title.c_str(), "spprcAlgorithm")){
+			string strtmp;
+			file >> strtmp;
+			options.spprcAlgorithm_ = stringToSPPRCAlgorithm[strtmp];
+		}
+		if(!strcmp(title.c_str(), "dualSmoothingAlpha")){
+			file >> options.dualSmoothingAlpha_;
+		}
+		if(!strcmp(title.c_str(), "lagrangianPlateau")){
+			file >> options.lagrangianPlateau_;
+		}
 	}
 
    std::ifstream fin(strOptionFile.c_str());
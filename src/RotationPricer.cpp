@@ -8,6 +8,8 @@
 #include "RotationPricer.h"
 #include "BcpModeler.h"
 
+#include <boost/functional/hash.hpp>
+
 /* namespace usage */
 using namespace std;
 
@@ -22,8 +24,11 @@ static char* baseName = "rotation";
 
 /* Constructs the pricer object. */
 RotationPricer::RotationPricer(MasterProblem* master, const char* name):
-                        MyPricer(name), nbMaxRotationsToAdd_(20), nbSubProblemsToSolve_(15), nursesToSolve_(master->theNursesSorted_),
-                        master_(master), pScenario_(master->pScenario_), nbDays_(master->pDemand_->nbDays_), pModel_(master->getModel())
+                        MyPricer(name), nbMaxRotationsToAdd_(20), nbSubProblemsToSolve_(15), nbMinSubProblemsSolvedByStage_(5),
+                        smoothingAlpha_(-1), maxSmoothingAlpha_(.9), smoothingAlphaStep_(.1), nurseStatsDecay_(.5), maxNurseAge_(5),
+                        nursesToSolve_(master->theNursesSorted_),
+                        master_(master), pScenario_(master->pScenario_), nbDays_(master->pDemand_->nbDays_), pModel_(master->getModel()),
+                        nextQueuedTask_(0), nbUnsolvedTasks_(0), batchBound_(0), stopPricingWorkers_(false)
 {
    /* sort the nurses */
 //   random_shuffle( nursesToSolve_.begin(), nursesToSolve_.end());
@@ -31,7 +36,19 @@ RotationPricer::RotationPricer(MasterProblem* master, const char* name):
 
 /* Destructs the pricer object. */
 RotationPricer::~RotationPricer() {
-   for(pair<const Contract*, SubProblem*> p: subProblems_)
+   //stop the pricing threads
+   {
+      lock_guard<mutex> lock(pricingMutex_);
+      stopPricingWorkers_ = true;
+   }
+   taskQueued_.notify_all();
+   for(thread& worker: pricingWorkers_)
+      worker.join();
+
+   for(map<const Contract*, SubProblem*>& subProblems: subProblems_)
+      for(pair<const Contract*, SubProblem*> p: subProblems)
+         delete p.second;
+   for(pair<const Contract*, spp_csr_topology*> p: topologies_)
       delete p.second;
 }
 
@@ -40,110 +57,253 @@ RotationPricer::~RotationPricer() {
  ******************************************************/
 bool RotationPricer::pricing(double bound, bool before_fathom){
    //=false if once optimality hasn't be proven
-   bool optimal = true;
+   bool optimal = false;
    //forbidden shifts
-   set<pair<int,int> > forbiddenShifts;
-   //computed new rotations
-   vector<Rotation> rotations;
+   DayShiftSet forbiddenShifts(nbDays_, pScenario_->nbShifts_);
+
+   //number of subproblems solved at the same time (size of the pool of pricing threads, including the master thread)
+   int nbThreads = max(1, pModel_->getParameters().nbPricingThreads_);
 
 //   std::cout << "# ------- BEGIN ------- Subproblems..." << std::endl;
+   Tools::Timer timerPricing;
+   timerPricing.init();
+   timerPricing.start();
+
+   //copy the duals of the lp once for all the subproblems of the round
+   fillDualSnapshot();
 
    //count and store the nurses for whom their subproblem has generated rotations.
    int nbSubProblemSolved = 0, nbIteration = 0;
    double minDualCoast = 0;
-   vector<LiveNurse*> nursesSolved;
-   for(vector<LiveNurse*>::iterator it0 = nursesToSolve_.begin(); it0 != nursesToSolve_.end();){
-      ++nbIteration;
-      LiveNurse* pNurse = *it0;
-
-      /* Build or re-use a subproblem */
-      SubProblem* subProblem;
-      //search the contract
-      map<const Contract*, SubProblem*>::iterator it =  subProblems_.find(pNurse->pContract_);
-
-      //if doesn't find => create new subproblem
-      if( it == subProblems_.end() ){
-         subProblem = new SubProblem(pScenario_, nbDays_, pNurse->pContract_, master_->pInitState_);
-         subProblems_.insert(it, pair<const Contract*, SubProblem*>(pNurse->pContract_, subProblem));
-      }
-
-      //otherwise retrieve the subproblem associated to the contract
-      else
-         subProblem = it->second;
-
-      /* Retrieves dual values */
-      vector< vector<double> > workDualCosts(getWorkDualValues(pNurse));
-      vector<double> startWorkDualCosts(getStartWorkDualValues(pNurse));
-      vector<double> endWorkDualCosts(getEndWorkDualValues(pNurse));
-      double workedWeekendDualCost = getWorkedWeekendDualValue(pNurse);
-
-      DualCosts dualCosts (workDualCosts, startWorkDualCosts, endWorkDualCosts, workedWeekendDualCost, true);
-
-      /* Compute forbidden */
-      computeForbiddenShifts(forbiddenShifts, rotations);
-      set<pair<int,int> > nurseForbiddenShifts(forbiddenShifts);
-      pModel_->addForbidenShifts(pNurse, nurseForbiddenShifts);
-
-	   /* Solve options */
-	   vector<SolveOption> options;
-	   options.push_back(SOLVE_ONE_SINK_PER_LAST_DAY);
-	   options.push_back(SOLVE_SHORT_ALL);
-
-	   /* Solve subproblems */
-      optimal = false;
-
-
-      subProblem->solve(pNurse, &dualCosts, options, forbiddenShifts, true , 120, bound);
+   size_t maxLabelMemory = 0;
+   long nbLabels = 0;
+   int nbReusedTasks = 0, nbTasksPriced = 0;
+   //number of arc costs updated / kept by the subproblems (incremental update of the costs)
+   long nbArcCostsUpdated = 0, nbArcCostsSkipped = 0;
+   //number of rotations rejected because they are already columns of the master, and number of nurses
+   //whose complete search has only found such rotations
+   int nbDuplicates = 0, nbNursesWithOnlyDuplicates = 0;
+   set<const LiveNurse*> pricedNurses;
+   //lower bounds on the reduced costs of the nurses for the duals of the lp (lagrangian bound): they are only known for the
+   //nurses solved exactly without smoothing (or reused), so the bound is only computed when all the nurses have been priced.
+   //they do not depend on the smoothing factor: they are kept after a mispricing
+   map<const LiveNurse*, double> minReducedCostBounds;
+   vector<LiveNurse*> nursesNotSolved;
+
+   //reduced cost arc elimination: an arc can be removed from the subtree if the cheapest rotation using it
+   //has a reduced cost larger than the gap between the incumbent and the current lp value
+   BcpModeler* model = dynamic_cast<BcpModeler*>(pModel_);
+   double eliminationGap = LARGE_SCORE;
+   if(model && model->getBestUB() < LARGE_SCORE)
+      eliminationGap = model->getBestUB() - model->getLastObj();
+   vector<pair<LiveNurse*, vector<int> > > arcsToEliminate;
+
+   //dual smoothing (Wentges): the subproblems are solved for a convex combination of the global stability center and
+   //of the duals of the lp. If no rotation has a negative reduced cost for the duals of the lp (mispricing), the pricing
+   //is repeated with a smaller smoothing factor, down to 0 (no smoothing)
+   if(smoothingAlpha_ < 0)
+      smoothingAlpha_ = min(maxSmoothingAlpha_, max(0.0, pModel_->getParameters().dualSmoothingAlpha_));
+   int nbMisprices = 0;
+   double alpha = 0;
+   do{
+      alpha = max(0.0, 1 - (nbMisprices+1) * (1 - smoothingAlpha_));
+      forbiddenShifts.clear();
+      arcsToEliminate.clear();
+
+      //pricing stages, from the cheapest to the exact one: the next stage is run only on the nurses without
+      //new rotations, and only if the previous stages have not generated rotations for enough nurses
+      vector<LiveNurse*> nursesToPrice = nursesToSolve_;
+      int nbMinSubProblemsSolved = min(nbMinSubProblemsSolvedByStage_, (int) nursesToSolve_.size());
+      for(int stage=PRICING_HEURISTIC; stage<NB_PRICING_STAGES; ++stage){
+         nursesNotSolved.clear();
+         int nbNursesPriced = 0;
+         while(nbNursesPriced < nursesToPrice.size() && nbSubProblemSolved < nbSubProblemsToSolve_){
+
+            /* Build the tasks of the next nurses on the master thread */
+            int nbTasks = min(nbThreads, (int) nursesToPrice.size() - nbNursesPriced);
+            vector<PricingTask> tasks(nbTasks);
+            for(int t=0; t<nbTasks; ++t){
+               PricingTask& task = tasks[t];
+               LiveNurse* pNurse = nursesToPrice[nbNursesPriced+t];
+               task.pNurse_ = pNurse;
+               task.stage_ = (PricingStage) stage;
+
+               /* Build or re-use a subproblem */
+               task.pSubProblem_ = retrieveSubProblem(pNurse, t);
+
+               /* Smooth the dual values of the lp with those of the stability center (nothing is copied otherwise) */
+               smoothDualValues(task, alpha);
+
+               /* Forbidden shifts (computed from the rotations of the previous nurses) */
+               task.forbiddenShifts_ = forbiddenShifts;
+
+               /* Arcs eliminated by reduced cost in the current node (subproblems are built the same way in all threads).
+                * New ones can only be found for the duals of the lp */
+               pModel_->addForbiddenArcs(pNurse, task.eliminatedArcs_);
+               task.eliminationGap_ = (stage == PRICING_EXACT && alpha == 0) ? eliminationGap : LARGE_SCORE;
+
+               /* Same inputs as the last time: reuse the result */
+               ++nbTasksPriced;
+               if(reuseLastPricing(task, bound))
+                  ++nbReusedTasks;
+            }
+
+            /* Solve subproblems with the pool of pricing threads */
+            solveTasks(tasks, bound, nbThreads);
+
+            /*
+             * Rotations: merged in the order of the nurses
+             */
+            for(PricingTask& task: tasks){
+               ++nbIteration;
+               ++nbNursesPriced;
+               pricedNurses.insert(task.pNurse_);
+               vector<Rotation> addedRotations;
+               bool completeSearch = false;
+               do{
+                  if(!task.cached_){
+                     maxLabelMemory = max(maxLabelMemory, task.pSubProblem_->peakLabelMemory());
+                     nbLabels += task.pSubProblem_->nbLabels();
+                     nbArcCostsUpdated += task.pSubProblem_->nArcsCostUpdated();
+                     nbArcCostsSkipped += task.pSubProblem_->nArcsCostSkipped();
+                     //the duals of the lp are only copied when they are stored to be compared with the next pricings
+                     PricingTask& lastTask = lastPricingTasks_[task.pNurse_];
+                     lastTask = task;
+                     if(!task.smoothed_)
+                        getNurseDualValues(dualSnapshot_, task.pNurse_, lastTask);
+                  }
+                  if(task.minReducedCostBound_ > -LARGE_SCORE)
+                     minReducedCostBounds[task.pNurse_] = task.minReducedCostBound_;
+
+                  /* Retrieve rotations */
+                  vector<Rotation>& rotations = task.rotations_;
+                  /* reduced costs for the duals of the lp: only the rotations of negative reduced cost are kept */
+                  if(alpha > 0){
+                     vector<Rotation> lpRotations;
+                     for(Rotation& rot: rotations){
+                        rot.dualCost_ += rotationDualValue(rot, taskDualCosts(task))
+                           - rotationDualValue(rot, DualCosts(dualSnapshot_, task.pNurse_->id_, task.pNurse_->pPosition_->id_));
+                        if(rot.dualCost_ < bound - EPSILON)
+                           lpRotations.push_back(rot);
+                     }
+                     rotations = lpRotations;
+                  }
+                  /* sort rotations */
+                  for(Rotation& rot: rotations){
+                     //the ids depend on the order of creation in the threads, and the reused rotations need new ones: renumber them
+                     if(nbThreads > 1 || task.cached_) rot.id_ = Rotation::s_count++;
+                     rot.computeCost(pScenario_, master_->pPreferences_, nbDays_);
+      //               rot.computeDualCost(dualCosts);
+                  }
+                  std::stable_sort(rotations.begin(), rotations.end(), Rotation::compareDualCost);
+                  /* add them to the master problem */
+                  for(Rotation& rot: rotations){
+                     //the rotation may already be a column of the current node (e.g. forbidden by branching)
+                     if(!master_->addPendingRotation(rot, baseName)){
+                        ++nbDuplicates;
+                        continue;
+                     }
+                     addedRotations.push_back(rot);
+                     if(addedRotations.size() >= nbMaxRotationsToAdd_)
+                        break;
+                  }
+
+                  /* All the rotations of the exact stage are already columns of the node: the k-best labeling may have
+                   * stopped before finding new ones. The subproblem is solved again on the master thread with a complete
+                   * search, so that no rotation of negative reduced cost can be missed */
+                  completeSearch = addedRotations.empty() && !rotations.empty() && task.stage_ == PRICING_EXACT
+                     && alpha == 0 && !task.completeSearch_;
+                  if(completeSearch){
+                     task.completeSearch_ = true;
+                     task.cached_ = false;
+                     solveTask(task, bound);
+                  }
+                  //the Pareto-fronts of the complete search only contain columns of the node: they may dominate new rotations
+                  else if(addedRotations.empty() && !rotations.empty() && task.stage_ == PRICING_EXACT && alpha == 0)
+                     ++nbNursesWithOnlyDuplicates;
+               } while(completeSearch);
+               updateNursePricingStats(task);
+               arcsToEliminate.push_back(pair<LiveNurse*, vector<int> >(task.pNurse_, task.arcsToEliminate_));
+
+               /* Compute forbidden (only from the new columns) */
+               computeForbiddenShifts(forbiddenShifts, addedRotations);
+
+               //count if the subproblem has generated some new rotations and then store the nurse
+               if(!addedRotations.empty()){
+                  ++nbSubProblemSolved;
+                  if(addedRotations[0].dualCost_ < minDualCoast)
+                     minDualCoast = addedRotations[0].dualCost_;
+               }
+               //try the next nurse
+               else
+                  nursesNotSolved.push_back(task.pNurse_);
+
+               //the maximum number of subproblems solved is only checked between two batches:
+               //the rotations of all the nurses of a batch are kept as they have been computed anyway
+            }
+         }
 
+         //the nurses that have not been priced in this stage
+         nursesNotSolved.insert(nursesNotSolved.end(), nursesToPrice.begin()+nbNursesPriced, nursesToPrice.end());
+
+         //optimality is proven only if the exact stage has priced all the nurses without finding any rotation
+         //for the duals of the lp (in this case, no rotation has been found by the previous stages: they priced all the nurses too).
+         //the nurses whose rotations were all duplicates have been solved again with a complete search: nothing is proven
+         //only if it has found duplicates again
+         if(stage == PRICING_EXACT)
+            optimal = (nbSubProblemSolved == 0) && (nbNursesPriced == nursesToPrice.size()) && (alpha == 0)
+               && (nbNursesWithOnlyDuplicates == 0);
+
+         //enough nurses with new rotations: the next stages are not needed
+         if(nbSubProblemSolved >= nbMinSubProblemsSolved)
+            break;
+         nursesToPrice = nursesNotSolved;
+      }
 
-	   /*
-	    * Rotations
-	    */
+      //mispricing: no rotation for the duals of the lp
+      if(nbSubProblemSolved == 0 && alpha > 0)
+         ++nbMisprices;
+   } while(nbSubProblemSolved == 0 && alpha > 0);
+
+   //automatic adjustment of the smoothing factor: larger if the smoothed duals have directly generated improving
+   //rotations, smaller after a mispricing
+   if(pModel_->getParameters().dualSmoothingAlpha_ > 0){
+      if(nbMisprices > 0)
+         smoothingAlpha_ = max(0.0, smoothingAlpha_ - smoothingAlphaStep_);
+      else if(nbSubProblemSolved > 0)
+         smoothingAlpha_ = min(maxSmoothingAlpha_, smoothingAlpha_ + smoothingAlphaStep_);
+   }
 
-		/* Retrieve rotations */
-		rotations = subProblem->getRotations();
-		/* sort rotations */
-      for(Rotation& rot: rotations){
-         rot.computeCost(pScenario_, master_->pPreferences_, nbDays_);
-//         rot.computeDualCost(dualCosts);
-      }
-		std::stable_sort(rotations.begin(), rotations.end(), Rotation::compareDualCost);
-		/* add them to the master problem */
-		int nbRotationsAdded = 0;
-		double best;
-		for(Rotation& rot: rotations){
-			master_->addRotation(rot, baseName);
-			++nbRotationsAdded;
-			if(nbRotationsAdded >= nbMaxRotationsToAdd_)
-			   break;
-		}
-
-
-      //count if the subproblem has generated some rotations and then store the nurse
-      if(rotations.size() > 0){
-         ++nbSubProblemSolved;
-         if(rotations[0].dualCost_ < minDualCoast)
-            minDualCoast = rotations[0].dualCost_;
-         nursesToSolve_.erase(it0);
-         nursesSolved.push_back(pNurse);
-      }
-      //try the next nurse
-      else {
-         ++it0;
-      }
-		//if the maximum number of subproblem solved is reached, break.
-		if(nbSubProblemSolved == nbSubProblemsToSolve_)
-		   break;
+   //the most promising nurses will be priced first at the next pricing
+   for(LiveNurse* pNurse: nursesToSolve_){
+      NursePricingStats& stats = nursePricingStats_[pNurse];
+      stats.age_ = pricedNurses.count(pNurse) ? 0 : stats.age_+1;
    }
+   sortNursesToSolve();
+
+   //if no rotation has been generated by the exact stage, the column generation has converged in this node:
+   //the duals are feasible and the arcs can be eliminated for its whole subtree
+   if(optimal)
+      for(pair<LiveNurse*, vector<int> >& p: arcsToEliminate)
+         pModel_->storeForbiddenArcs(p.first, p.second);
 
-   //Add the nurse in nursesSolved at the end
-   nursesToSolve_.insert(nursesToSolve_.end(), nursesSolved.begin(), nursesSolved.end());
+   //create the columns of all the new rotations at once
+   master_->createPendingRotations();
 
    //set statistics
-   BcpModeler* model = dynamic_cast<BcpModeler*>(pModel_);
+   timerPricing.stop();
    if(model){
       model->setLastNbSubProblemsSolved(nbIteration);
       model->setLastMinDualCost(minDualCoast);
+      model->setLastMaxLabelMemory(maxLabelMemory);
+      model->setLastNbLabels(nbLabels);
+      model->addPricingCacheLookups(nbReusedTasks, nbTasksPriced);
+      model->addArcCostUpdates(nbArcCostsUpdated, nbArcCostsSkipped);
+      model->addPricing(timerPricing.dSinceInit(), nbMisprices);
+      model->addDuplicateColumns(nbDuplicates);
+      //the duals of the lp become the stability center only if they improve the lagrangian bound of the node
+      if(model->updateLagrangianBound(computeLagrangianBound(minReducedCostBounds)))
+         stabilityCenter_ = dualSnapshot_;
    }
 
 //   std::cout << "# -------  END  ------- Subproblems!" << std::endl;
@@ -152,99 +312,409 @@ bool RotationPricer::pricing(double bound, bool before_fathom){
 }
 
 /******************************************************
- * Get the duals values per day for a nurse
+ * Solve the tasks of a batch with the pool of pricing threads
  ******************************************************/
-vector< vector<double> > RotationPricer::getWorkDualValues(LiveNurse* pNurse){
-   vector< vector<double> > dualValues(nbDays_);
-   int i = pNurse->id_;
-   int p = pNurse->pContract_->id_;
+void RotationPricer::solveTasks(vector<PricingTask>& tasks, double bound, int nbThreads){
+   //start the missing pricing threads (the master thread is one of them)
+   while(pricingWorkers_.size() < nbThreads-1)
+      pricingWorkers_.push_back( thread(&RotationPricer::runPricingWorker, this) );
+
+   //queue the tasks that are not cached
+   unique_lock<mutex> lock(pricingMutex_);
+   queuedTasks_.clear();
+   for(PricingTask& task: tasks)
+      if(!task.cached_)
+         queuedTasks_.push_back(&task);
+   nextQueuedTask_ = 0;
+   nbUnsolvedTasks_ = queuedTasks_.size();
+   batchBound_ = bound;
+   taskQueued_.notify_all();
+
+   //the master thread solves tasks too, then waits for those of the other threads
+   while(nextQueuedTask_ < queuedTasks_.size()){
+      PricingTask* pTask = queuedTasks_[nextQueuedTask_++];
+      lock.unlock();
+      solveTask(*pTask, bound);
+      lock.lock();
+      --nbUnsolvedTasks_;
+   }
+   batchSolved_.wait(lock, [this]{ return nbUnsolvedTasks_ == 0; });
+}
 
-   /* Min/Max constraints */
-   double minWorkedDays = pModel_->getDual(master_->minWorkedDaysCons_[i], true);
-   double maxWorkedDays = pModel_->getDual(master_->maxWorkedDaysCons_[i], true);
+/******************************************************
+ * Loop of a pricing thread
+ ******************************************************/
+void RotationPricer::runPricingWorker(){
+   unique_lock<mutex> lock(pricingMutex_);
+   while(true){
+      taskQueued_.wait(lock, [this]{ return stopPricingWorkers_ || nextQueuedTask_ < queuedTasks_.size(); });
+      if(stopPricingWorkers_)
+         return;
+      PricingTask* pTask = queuedTasks_[nextQueuedTask_++];
+      double bound = batchBound_;
+      lock.unlock();
+      solveTask(*pTask, bound);
+      lock.lock();
+      if(--nbUnsolvedTasks_ == 0)
+         batchSolved_.notify_all();
+   }
+}
 
-   double minWorkedDaysAvg = master_->isMinWorkedDaysAvgCons_[i] ? pModel_->getDual(master_->minWorkedDaysAvgCons_[i], true):0.0;
-   double maxWorkedDaysAvg = master_->isMaxWorkedDaysAvgCons_[i] ? pModel_->getDual(master_->maxWorkedDaysAvgCons_[i], true):0.0;
+/******************************************************
+ * Get or build the subproblem of a nurse for a thread
+ ******************************************************/
+SubProblem* RotationPricer::retrieveSubProblem(LiveNurse* pNurse, int threadIndex){
+   //one map of subproblems per thread
+   if(subProblems_.size() <= threadIndex)
+      subProblems_.resize(threadIndex+1);
+   map<const Contract*, SubProblem*>& subProblems = subProblems_[threadIndex];
+
+   //search the contract
+   map<const Contract*, SubProblem*>::iterator it =  subProblems.find(pNurse->pContract_);
+
+   //if doesn't find => create new subproblem
+   if( it == subProblems.end() ){
+      spp_csr_topology*& pTopology = topologies_[pNurse->pContract_];
+      if(!pTopology) pTopology = new spp_csr_topology();
+      SubProblem* subProblem = new SubProblem(pScenario_, nbDays_, pNurse->pContract_, master_->pInitState_, pTopology);
+      subProblems.insert(it, pair<const Contract*, SubProblem*>(pNurse->pContract_, subProblem));
+      return subProblem;
+   }
 
-   double minWorkedDaysContractAvg = master_->isMinWorkedDaysContractAvgCons_[p] ?
-      pModel_->getDual(master_->minWorkedDaysContractAvgCons_[p], true):0.0;
-   double maxWorkedDaysContractAvg = master_->isMaxWorkedDaysContractAvgCons_[p] ?
-      pModel_->getDual(master_->maxWorkedDaysContractAvgCons_[p], true):0.0;
+   //otherwise retrieve the subproblem associated to the contract
+   return it->second;
+}
 
+/******************************************************
+ * Reuse the result of the last pricing of the nurse of a task
+ * if it has been computed with the same inputs
+ ******************************************************/
+bool RotationPricer::reuseLastPricing(PricingTask& task, double bound){
+   //hash of the inputs (the duals are read in place)
+   DualCosts duals = taskDualCosts(task);
+   int nbShifts = pScenario_->nbShifts_-1;
+   size_t hash = 0;
+   boost::hash_combine(hash, (int) task.stage_);
+   boost::hash_combine(hash, bound);
+   boost::hash_combine(hash, duals.workedWeekendCost());
    for(int k=0; k<nbDays_; ++k){
-      //initialize vector
-      vector<double> dualValues2(pScenario_->nbShifts_-1);
-
-      for(int s=1; s<pScenario_->nbShifts_; ++s){
-         /* Min/Max constraints */
-         dualValues2[s-1] = minWorkedDays + minWorkedDaysAvg + minWorkedDaysContractAvg;
-         dualValues2[s-1] += maxWorkedDays + maxWorkedDaysAvg + maxWorkedDaysContractAvg;
+      for(int s=0; s<nbShifts; ++s)
+         boost::hash_combine(hash, duals.dayShiftWorkCost(k, s));
+      boost::hash_combine(hash, duals.startWorkCost(k));
+      boost::hash_combine(hash, duals.endWorkCost(k));
+   }
+   boost::hash_range(hash, task.forbiddenShifts_.words_.begin(), task.forbiddenShifts_.words_.end());
+   boost::hash_range(hash, task.eliminatedArcs_.begin(), task.eliminatedArcs_.end());
+   boost::hash_combine(hash, task.eliminationGap_);
+   task.bound_ = bound;
+   task.inputHash_ = hash;
+   task.cached_ = false;
+
+   //compare with the inputs of the last pricing (the hash is checked first)
+   map<const LiveNurse*, PricingTask>::iterator it = lastPricingTasks_.find(task.pNurse_);
+   if(it == lastPricingTasks_.end())
+      return false;
+   const PricingTask& lastTask = it->second;
+   if(lastTask.inputHash_ != hash || lastTask.stage_ != task.stage_ || lastTask.bound_ != bound
+         || !sameDualValues(lastTask, duals)
+         || !(lastTask.forbiddenShifts_ == task.forbiddenShifts_) || lastTask.eliminatedArcs_ != task.eliminatedArcs_
+         || lastTask.eliminationGap_ != task.eliminationGap_)
+      return false;
+
+   //same inputs: same rotations (or same proof that there is none)
+   task.rotations_ = lastTask.rotations_;
+   task.arcsToEliminate_ = lastTask.arcsToEliminate_;
+   //the bound on the reduced costs is computed for the duals of the lp: it can be reused only if they have not been smoothed
+   task.minReducedCostBound_ = (task.smoothed_ || lastTask.smoothed_) ? -LARGE_SCORE : lastTask.minReducedCostBound_;
+   task.cached_ = true;
+   return true;
+}
 
-         /* Skills coverage */
-         dualValues2[s-1] += pModel_->getDual(
-            master_->numberOfNursesByPositionCons_[k][s-1][pNurse->pPosition_->id_], true);
-      }
+/******************************************************
+ * Update the pricing statistics of the nurse of a task
+ * once its rotations are sorted
+ ******************************************************/
+void RotationPricer::updateNursePricingStats(const PricingTask& task){
+   NursePricingStats& stats = nursePricingStats_[task.pNurse_];
+   bool hit = !task.rotations_.empty();
+   stats.lastBestReducedCost_ = hit ? task.rotations_[0].dualCost_ : 0;
+   if(stats.nbPricings_ == 0){
+      stats.hitFrequency_ = hit ? 1 : 0;
+      stats.solveTime_ = task.solveTime_;
+   }
+   else{
+      stats.hitFrequency_ = nurseStatsDecay_ * stats.hitFrequency_ + (1-nurseStatsDecay_) * (hit ? 1 : 0);
+      //a reused result says nothing about the solve time
+      if(!task.cached_)
+         stats.solveTime_ = nurseStatsDecay_ * stats.solveTime_ + (1-nurseStatsDecay_) * task.solveTime_;
+   }
+   ++stats.nbPricings_;
+}
 
-      //store vector
-      dualValues[k] = dualValues2;
+/******************************************************
+ * Sort the nurses to solve from the most promising to
+ * the least one
+ ******************************************************/
+void RotationPricer::sortNursesToSolve(){
+   //score of the nurses: expected decrease of the reduced cost per second of pricing
+   //(infinite for the nurses that have never been priced)
+   map<const LiveNurse*, double> scores;
+   for(LiveNurse* pNurse: nursesToSolve_){
+      const NursePricingStats& stats = nursePricingStats_[pNurse];
+      scores[pNurse] = (stats.nbPricings_ == 0) ? DBL_MAX :
+         - stats.hitFrequency_ * stats.lastBestReducedCost_ / max(stats.solveTime_, 1e-6);
    }
 
-   return dualValues;
+   //aging: the nurses that have not been priced for maxNurseAge_ pricings come first (oldest first),
+   //so that every nurse is eventually priced. Then the best scores come first
+   std::stable_sort(nursesToSolve_.begin(), nursesToSolve_.end(),
+      [&](LiveNurse* n1, LiveNurse* n2){
+         int age1 = nursePricingStats_[n1].age_, age2 = nursePricingStats_[n2].age_;
+         bool old1 = age1 >= maxNurseAge_, old2 = age2 >= maxNurseAge_;
+         if(old1 != old2) return old1;
+         if(old1) return age1 > age2;
+         if(scores[n1] != scores[n2]) return scores[n1] > scores[n2];
+         return age1 > age2;
+      });
 }
 
+/******************************************************
+ * Lagrangian bound: lp value + sum over the nurses of the
+ * maximum number of rotations times the minimum reduced cost
+ ******************************************************/
+double RotationPricer::computeLagrangianBound(const map<const LiveNurse*, double>& minReducedCostBounds){
+   BcpModeler* model = dynamic_cast<BcpModeler*>(pModel_);
+   if(!model)
+      return LARGE_SCORE;
+
+   //a roster contains at most one rotation every two days (a rotation is followed by a rest day)
+   int maxNbRotations = (nbDays_+1) / 2;
+   double bound = model->getLastObj();
+   for(LiveNurse* pNurse: nursesToSolve_){
+      map<const LiveNurse*, double>::const_iterator it = minReducedCostBounds.find(pNurse);
+      if(it == minReducedCostBounds.end())
+         return LARGE_SCORE;
+      bound += maxNbRotations * min(0.0, it->second);
+   }
+   return bound;
+}
 
-vector<double> RotationPricer::getStartWorkDualValues(LiveNurse* pNurse){
-   int i = pNurse->id_;
-   vector<double> dualValues(nbDays_);
+/******************************************************
+ * Smooth the dual values of the lp of a task with those
+ * of its nurse in the stability center
+ ******************************************************/
+void RotationPricer::smoothDualValues(PricingTask& task, double alpha){
+   //no stability center before the first lagrangian bound: the subproblem reads the duals of the lp in the snapshot
+   task.smoothed_ = alpha > 0 && stabilityCenter_.nbDays_ > 0;
+   if(!task.smoothed_)
+      return;
+
+   int i = task.pNurse_->id_, p = task.pNurse_->pPosition_->id_, nbShifts = pScenario_->nbShifts_-1;
+   DualCosts lp(dualSnapshot_, i, p), center(stabilityCenter_, i, p);
+   task.workDualCosts_.resize(nbDays_*nbShifts);
+   task.startWorkDualCosts_.resize(nbDays_);
+   task.endWorkDualCosts_.resize(nbDays_);
+   for(int k=0; k<nbDays_; ++k){
+      for(int s=0; s<nbShifts; ++s)
+         task.workDualCosts_[k*nbShifts+s] = alpha * center.dayShiftWorkCost(k, s) + (1-alpha) * lp.dayShiftWorkCost(k, s);
+      task.startWorkDualCosts_[k] = alpha * center.startWorkCost(k) + (1-alpha) * lp.startWorkCost(k);
+      task.endWorkDualCosts_[k] = alpha * center.endWorkCost(k) + (1-alpha) * lp.endWorkCost(k);
+   }
+   task.workedWeekendDualCost_ = alpha * center.workedWeekendCost() + (1-alpha) * lp.workedWeekendCost();
+}
 
-   //get dual value associated to the source
-   dualValues[0] =  pModel_->getDual(master_->restFlowCons_[i][0], true);
-   //get dual values associated to the work flow constraints
-   //don't take into account the last which is the sink
-   for(int k=1; k<nbDays_; ++k)
-      dualValues[k] = pModel_->getDual(master_->workFlowCons_[i][k-1], true);
+/******************************************************
+ * Duals for which the subproblem of a task is solved
+ ******************************************************/
+DualCosts RotationPricer::taskDualCosts(PricingTask& task){
+   if(task.smoothed_)
+      return DualCosts(task.workDualCosts_.data(), pScenario_->nbShifts_-1, 0,
+         task.startWorkDualCosts_.data(), task.endWorkDualCosts_.data(), task.workedWeekendDualCost_);
+   return DualCosts(dualSnapshot_, task.pNurse_->id_, task.pNurse_->pPosition_->id_);
+}
 
-   return dualValues;
+/******************************************************
+ * Compare the stored dual values of a nurse with a view
+ ******************************************************/
+bool RotationPricer::sameDualValues(const NurseDualValues& duals, DualCosts dualCosts){
+   int nbShifts = pScenario_->nbShifts_-1;
+   if(duals.workDualCosts_.size() != nbDays_*nbShifts || duals.workedWeekendDualCost_ != dualCosts.workedWeekendCost())
+      return false;
+   for(int k=0; k<nbDays_; ++k){
+      for(int s=0; s<nbShifts; ++s)
+         if(duals.workDualCosts_[k*nbShifts+s] != dualCosts.dayShiftWorkCost(k, s))
+            return false;
+      if(duals.startWorkDualCosts_[k] != dualCosts.startWorkCost(k) || duals.endWorkDualCosts_[k] != dualCosts.endWorkCost(k))
+         return false;
+   }
+   return true;
 }
 
-vector<double> RotationPricer::getEndWorkDualValues(LiveNurse* pNurse){
-   int i = pNurse->id_;
-   vector<double> dualValues(nbDays_);
+/******************************************************
+ * Sum of the dual values covered by a rotation
+ * (its reduced cost is its cost minus this sum)
+ ******************************************************/
+double RotationPricer::rotationDualValue(const Rotation& rot, DualCosts duals){
+   int lastDay = rot.firstDay_+rot.length_-1;
+   double dualValue = duals.startWorkCost(rot.firstDay_) + duals.endWorkCost(lastDay);
+   for(int k=rot.firstDay_; k<=lastDay; ++k){
+      dualValue += duals.dayShiftWorkCost(k, rot.shift(k)-1);
+      if(Tools::isSaturday(k))
+         dualValue += duals.workedWeekendCost();
+   }
+   if(Tools::isSunday(rot.firstDay_))
+      dualValue += duals.workedWeekendCost();
+   return dualValue;
+}
+
+/******************************************************
+ * Solve the subproblem of a task (may run in a pricing thread)
+ ******************************************************/
+void RotationPricer::solveTask(PricingTask& task, double bound){
+   Tools::Timer timerSolve;
+   timerSolve.init();
+   timerSolve.start();
+   //the subproblem reads the duals of the lp directly in the snapshot, the smoothed ones in the task
+   DualCosts dualCosts = taskDualCosts(task);
+
+   /* Solve options */
+   SolveOptionMask options = solveOptionBit(SOLVE_ONE_SINK_PER_LAST_DAY) | solveOptionBit(SOLVE_SHORT_ALL);
+   SPPRCAlgorithm algorithm = pModel_->getParameters().spprcAlgorithm_;
+   //restricted stage with a label budget: day-bucketed (or bidirectional) labeling with at most this many labels per node
+   int labelBudget = pModel_->getParameters().spprcLabelBudget_;
+   if(task.stage_ == PRICING_RESTRICTED && labelBudget > 0){
+      if(algorithm == SPPRC_BOOST)
+         algorithm = SPPRC_DAY_BUCKETS;
+      options |= solveOptionBit(SOLVE_LABELS_BUDGET);
+      task.pSubProblem_->setLabelBudget(labelBudget);
+   }
+   //otherwise stop the labeling when enough rotations have been found (the search is complete if none is found),
+   //unless a complete search is needed
+   else if(!task.completeSearch_){
+      options |= solveOptionBit(SOLVE_LABELS_KBEST);
+      task.pSubProblem_->setNbKBestLabels(nbMaxRotationsToAdd_);
+   }
+   if(algorithm == SPPRC_DAY_BUCKETS)
+      options |= solveOptionBit(SOLVE_SPPRC_DAY_BUCKETS);
+   else if(algorithm == SPPRC_BIDIRECTIONAL)
+      options |= solveOptionBit(SOLVE_SPPRC_BIDIRECTIONAL);
+
+   /* Solve subproblems: greedy heuristic, exact on the rotations not longer than the maximum number of
+    * consecutive worked days of the contract, or exact */
+   bool exact = task.stage_ != PRICING_HEURISTIC;
+   int maxRotationLength = (task.stage_ == PRICING_RESTRICTED) ? task.pNurse_->pContract_->maxConsDaysWork_ : 120;
+   task.pSubProblem_->setEliminatedArcs(task.eliminatedArcs_);
+   task.pSubProblem_->solve(task.pNurse_, &dualCosts, options, task.forbiddenShifts_, exact, maxRotationLength, bound);
+
+   /* Arcs that can be eliminated if no rotation is generated for any nurse */
+   if(task.eliminationGap_ < LARGE_SCORE)
+      task.arcsToEliminate_ = task.pSubProblem_->arcsToEliminate(task.eliminationGap_);
+
+   /* Retrieve rotations */
+   task.rotations_ = task.pSubProblem_->getRotations();
+
+   /* Lower bound on the reduced costs of the nurse for the duals of the lp (for the lagrangian bound): it does not depend
+    * on the forbidden shifts and the eliminated arcs, and is read from the arc costs of the solve. It is only known after an
+    * exact solve (restricted or exact stage) for the duals of the lp */
+   task.minReducedCostBound_ = (exact && !task.smoothed_) ? task.pSubProblem_->minReducedCostLowerBound() : -LARGE_SCORE;
+
+   timerSolve.stop();
+   task.solveTime_ = timerSolve.dSinceInit();
+}
 
-   //get dual values associated to the work flow constraints
-   //don't take into account the first which is the source
-   //take into account the cost, if the last day worked is k
-   for(int k=0; k<nbDays_-1; ++k)
-      dualValues[k] = -pModel_->getDual(master_->restFlowCons_[i][k+1], true);
+/******************************************************
+ * Copy the duals values of the lp in the snapshot shared
+ * by the subproblems of all the nurses
+ ******************************************************/
+void RotationPricer::fillDualSnapshot(){
+   int nbShifts = pScenario_->nbShifts_-1;
+   dualSnapshot_.init(nbDays_, nbShifts, pScenario_->nbPositions(), pScenario_->nbNurses_);
 
-   //get dual value associated to the sink
-   dualValues[nbDays_-1] =  pModel_->getDual(
-      master_->workFlowCons_[i][nbDays_-1], true);
+   //read the duals directly in the dual solution of the modeler when available (no virtual call per constraint)
+   BcpModeler* model = dynamic_cast<BcpModeler*>(pModel_);
+   const vector<double>* lpDuals = (model && !model->getDualValues().empty()) ? &model->getDualValues() : 0;
+   auto dual = [&](MyCons* cons){
+      return lpDuals ? (*lpDuals)[((CoinCons*) cons)->getIndex()] : pModel_->getDual(cons, true);
+   };
+
+   /* Skills coverage: the same for all the nurses of a position */
+   for(int p=0; p<pScenario_->nbPositions(); ++p){
+      double* coverageDuals = &dualSnapshot_.coverageDuals_[p*nbDays_*nbShifts];
+      for(int k=0; k<nbDays_; ++k)
+         for(int s=1; s<=nbShifts; ++s)
+            coverageDuals[k*nbShifts+s-1] = dual(master_->numberOfNursesByPositionCons_[k][s-1][p]);
+   }
 
-   return dualValues;
+   for(LiveNurse* pNurse: nursesToSolve_){
+      int i = pNurse->id_;
+      int p = pNurse->pContract_->id_;
+
+      /* Min/Max constraints */
+      double minWorkedDays = dual(master_->minWorkedDaysCons_[i]);
+      double maxWorkedDays = dual(master_->maxWorkedDaysCons_[i]);
+
+      double minWorkedDaysAvg = master_->isMinWorkedDaysAvgCons_[i] ? dual(master_->minWorkedDaysAvgCons_[i]):0.0;
+      double maxWorkedDaysAvg = master_->isMaxWorkedDaysAvgCons_[i] ? dual(master_->maxWorkedDaysAvgCons_[i]):0.0;
+
+      double minWorkedDaysContractAvg = master_->isMinWorkedDaysContractAvgCons_[p] ?
+         dual(master_->minWorkedDaysContractAvgCons_[p]):0.0;
+      double maxWorkedDaysContractAvg = master_->isMaxWorkedDaysContractAvgCons_[p] ?
+         dual(master_->maxWorkedDaysContractAvgCons_[p]):0.0;
+
+      dualSnapshot_.workDuals_[i] = minWorkedDays + minWorkedDaysAvg + minWorkedDaysContractAvg;
+      dualSnapshot_.workDuals_[i] += maxWorkedDays + maxWorkedDaysAvg + maxWorkedDaysContractAvg;
+
+      /* Flow constraints */
+      double* startWorkDuals = &dualSnapshot_.startWorkDuals_[i*nbDays_];
+      double* endWorkDuals = &dualSnapshot_.endWorkDuals_[i*nbDays_];
+      //get dual value associated to the source
+      startWorkDuals[0] = dual(master_->restFlowCons_[i][0]);
+      //get dual values associated to the work flow constraints
+      //don't take into account the last which is the sink
+      for(int k=1; k<nbDays_; ++k)
+         startWorkDuals[k] = dual(master_->workFlowCons_[i][k-1]);
+      //don't take into account the first which is the source
+      //take into account the cost, if the last day worked is k
+      for(int k=0; k<nbDays_-1; ++k)
+         endWorkDuals[k] = -dual(master_->restFlowCons_[i][k+1]);
+      //get dual value associated to the sink
+      endWorkDuals[nbDays_-1] = dual(master_->workFlowCons_[i][nbDays_-1]);
+
+      /* Worked weekends */
+      double workedWeekendDual = dual(master_->maxWorkedWeekendCons_[i]);
+      if(master_->isMaxWorkedWeekendAvgCons_[i])
+         workedWeekendDual += dual(master_->maxWorkedWeekendAvgCons_[i]);
+      if(master_->isMaxWorkedWeekendContractAvgCons_[p])
+         workedWeekendDual += dual(master_->maxWorkedWeekendContractAvgCons_[p]);
+      dualSnapshot_.workedWeekendDuals_[i] = workedWeekendDual;
+   }
 }
 
-double RotationPricer::getWorkedWeekendDualValue(LiveNurse* pNurse){
-  int id = pNurse->id_;
-  double dualVal = pModel_->getDual(master_->maxWorkedWeekendCons_[id], true);
-  if (master_->isMaxWorkedWeekendAvgCons_[id]) {
-    dualVal += pModel_->getDual(master_->maxWorkedWeekendAvgCons_[id], true);
-  }
-  if (master_->isMaxWorkedWeekendContractAvgCons_[pNurse->pContract_->id_]) {
-     dualVal += pModel_->getDual(master_->maxWorkedWeekendContractAvgCons_[pNurse->pContract_->id_], true);
-  }
-
-  return dualVal;
+/******************************************************
+ * Get the duals values per day and per shift for a nurse
+ * from a snapshot
+ ******************************************************/
+void RotationPricer::getNurseDualValues(const DualSnapshot& snapshot, LiveNurse* pNurse, NurseDualValues& duals){
+   int i = pNurse->id_;
+   int nbWorkCosts = nbDays_*snapshot.nbShifts_;
+   const double* coverageDuals = snapshot.coverageDuals(pNurse->pPosition_->id_);
+
+   duals.workDualCosts_.resize(nbWorkCosts);
+   for(int j=0; j<nbWorkCosts; ++j)
+      duals.workDualCosts_[j] = coverageDuals[j] + snapshot.workDuals_[i];
+   duals.startWorkDualCosts_.assign(snapshot.startWorkDuals(i), snapshot.startWorkDuals(i)+nbDays_);
+   duals.endWorkDualCosts_.assign(snapshot.endWorkDuals(i), snapshot.endWorkDuals(i)+nbDays_);
+   duals.workedWeekendDualCost_ = snapshot.workedWeekendDuals_[i];
 }
 
 /******************************************************
  * add some forbidden shifts
  ******************************************************/
-void RotationPricer::computeForbiddenShifts(set<pair<int,int>>& forbiddenShifts, vector<Rotation> rotations){
+void RotationPricer::computeForbiddenShifts(DayShiftSet& forbiddenShifts, const vector<Rotation>& rotations){
    //search best rotation
-   vector<Rotation>::iterator bestRotation;
+   vector<Rotation>::const_iterator bestRotation;
    double bestDualcost = DBL_MAX;
-   for(vector<Rotation>::iterator it = rotations.begin(); it != rotations.end(); ++it)
+   for(vector<Rotation>::const_iterator it = rotations.begin(); it != rotations.end(); ++it)
       if(it->dualCost_ < bestDualcost){
          bestDualcost = it->dualCost_;
          bestRotation = it;
@@ -252,8 +722,8 @@ void RotationPricer::computeForbiddenShifts(set<pair<int,int>>& forbiddenShifts,
 
    //forbid shifts of the best rotation
    if(bestDualcost != DBL_MAX)
-      for(pair<int,int> pair: bestRotation->shifts_)
-            forbiddenShifts.insert(pair);
+      for(int k=bestRotation->firstDay_; k<bestRotation->firstDay_+bestRotation->length_; ++k)
+            forbiddenShifts.insert(k, bestRotation->shift(k));
 
 }
 
@@ -15,6 +15,10 @@
 #include "SubProblem.h"
 #include "Modeler.h"
 
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
 /* namespace usage */
 using namespace std;
 
@@ -39,30 +43,172 @@ private:
    Modeler* pModel_;
 
    //map of the contract and sub problems
-   //one subproblem per type of contract
+   //one subproblem per type of contract and per pricing thread
    //
    vector<LiveNurse*> nursesToSolve_;
-   map<const Contract*, SubProblem*> subProblems_;
+   vector< map<const Contract*, SubProblem*> > subProblems_;
+
+   //network topology of each contract, built once by the first subproblem
+   //of the contract and shared read-only by the subproblems of all threads
+   //
+   map<const Contract*, spp_csr_topology*> topologies_;
+
+   //pricing stages, from the cheapest to the exact one
+   //
+   enum PricingStage {PRICING_HEURISTIC, PRICING_RESTRICTED, PRICING_EXACT, NB_PRICING_STAGES};
+
+   //dual values of the master constraints for the subproblem of a nurse
+   //(the work dual costs are indexed by day*(nbShifts-1)+shift-1)
+   //
+   struct NurseDualValues{
+      vector<double> workDualCosts_;
+      vector<double> startWorkDualCosts_, endWorkDualCosts_;
+      double workedWeekendDualCost_;
+   };
+
+   //data of the subproblem of a nurse for one pricing round:
+   //filled on the master thread, solved by one of the pricing threads.
+   //the dual values of the task are only filled if they are smoothed (or for the cache of the last pricings):
+   //otherwise the subproblem reads those of the lp in the snapshot
+   //
+   struct PricingTask: public NurseDualValues{
+      LiveNurse* pNurse_;
+      SubProblem* pSubProblem_;
+      PricingStage stage_;
+      DayShiftSet forbiddenShifts_;
+      //arcs eliminated by reduced cost in the current node, and reduced cost gap to eliminate new ones (none if LARGE_SCORE)
+      vector<int> eliminatedArcs_;
+      double eliminationGap_;
+      vector<Rotation> rotations_;
+      vector<int> arcsToEliminate_;
+      //reduced cost bound, hash of the inputs (stage, duals, forbidden shifts, eliminated arcs and bound),
+      //and true if the result is reused from the last pricing of the nurse
+      double bound_;
+      size_t inputHash_;
+      bool cached_;
+      //time spent in the subproblem (s)
+      double solveTime_ = 0;
+      //true if the duals of the subproblem differ from those of the lp
+      bool smoothed_ = false;
+      //true if the labeling must not stop after the k best rotations (they were all columns of the node already)
+      bool completeSearch_ = false;
+      //lower bound on the reduced cost of the rotations of the nurse for the duals of the lp (-LARGE_SCORE if unknown)
+      double minReducedCostBound_ = -LARGE_SCORE;
+   };
+
+   //statistics of the last pricings of a nurse, used to price the most promising nurses first
+   //
+   struct NursePricingStats{
+      int nbPricings_ = 0;
+      //number of pricings since the nurse was last priced
+      int age_ = 0;
+      //best reduced cost found at the last pricing (0 if no rotation has been generated)
+      double lastBestReducedCost_ = 0;
+      //exponentially smoothed frequency of the pricings that have generated rotations, and time spent in the subproblem
+      double hitFrequency_ = 0, solveTime_ = 0;
+   };
+   map<const LiveNurse*, NursePricingStats> nursePricingStats_;
+
+   //result of the last pricing of each nurse: it is reused as long as the inputs of the nurse do not change
+   //
+   map<const LiveNurse*, PricingTask> lastPricingTasks_;
+
+   //dual smoothing (Wentges): global stability center, i.e. the duals of the lp that have given the best lagrangian
+   //bound of the node (empty until a first bound is computed; kept by the children until they improve on it)
+   //
+   DualSnapshot stabilityCenter_;
+
+   //dual values of the lp, copied once per pricing round and shared by the subproblems of all the nurses
+   //
+   DualSnapshot dualSnapshot_;
+
+   //persistent pool of pricing threads (the master thread is one of them): they wait for the tasks of a batch in a shared queue.
+   //the queue and the number of tasks of the batch that are not solved yet are protected by the mutex
+   //
+   vector<thread> pricingWorkers_;
+   mutex pricingMutex_;
+   condition_variable taskQueued_, batchSolved_;
+   vector<PricingTask*> queuedTasks_;
+   int nextQueuedTask_, nbUnsolvedTasks_;
+   double batchBound_;
+   bool stopPricingWorkers_;
 
    /*
     * Settings
     */
    int nbMaxRotationsToAdd_, nbSubProblemsToSolve_;
+   //a pricing stage is enough if it has generated rotations for at least this many nurses
+   int nbMinSubProblemsSolvedByStage_;
+   //current smoothing factor of the duals (initialized with the parameters at the first pricing),
+   //its maximum value and the step of its automatic adjustment
+   double smoothingAlpha_, maxSmoothingAlpha_, smoothingAlphaStep_;
+   //weight of the past in the pricing statistics of the nurses, and number of pricings after which a nurse
+   //that has not been priced comes first
+   double nurseStatsDecay_;
+   int maxNurseAge_;
 
    /*
     * Methods
     */
 
-   //get the duals values per day and per shift for a nurse
+   //get (or build) the subproblem of the contract of the nurse for the given thread
+   //
+   SubProblem* retrieveSubProblem(LiveNurse* pNurse, int threadIndex);
+
+   //solve the subproblem of a task and store its rotations
+   //
+   void solveTask(PricingTask& task, double bound);
+
+   //solve the tasks of a batch that are not cached with the pool of pricing threads (started if needed), and wait for all of them
+   //
+   void solveTasks(vector<PricingTask>& tasks, double bound, int nbThreads);
+
+   //loop of a pricing thread: solve the queued tasks until the pricer is destroyed
+   //
+   void runPricingWorker();
+
+   //update the pricing statistics of the nurse of a task, and sort the nurses to solve from these statistics
+   //
+   void updateNursePricingStats(const PricingTask& task);
+   void sortNursesToSolve();
+
+   //smooth the dual values of the lp of a task with those of its nurse in the stability center
+   //
+   void smoothDualValues(PricingTask& task, double alpha);
+
+   //duals for which the subproblem of a task is solved: the smoothed ones of the task or those of the lp in the snapshot
+   //
+   DualCosts taskDualCosts(PricingTask& task);
+
+   //sum of the dual values covered by a rotation
+   //
+   double rotationDualValue(const Rotation& rot, DualCosts duals);
+
+   //true if the dual values stored for the last pricing of a nurse are equal to those given by a view
+   //
+   bool sameDualValues(const NurseDualValues& duals, DualCosts dualCosts);
+
+   //lagrangian lower bound of the lp of the node from the bounds on the reduced costs of all the nurses
+   //(LARGE_SCORE if one of them is unknown)
+   //
+   double computeLagrangianBound(const map<const LiveNurse*, double>& minReducedCostBounds);
+
+   //hash the inputs of a task, and reuse the result of the last pricing of the nurse if they have not changed
+   //(returns true in this case)
+   //
+   bool reuseLastPricing(PricingTask& task, double bound);
+
+   //copy the dual values of the lp in the snapshot of the pricing round
+   //
+   void fillDualSnapshot();
+
+   //get the duals values per day and per shift for a nurse from a snapshot (only to store them in the cache)
    //
-   vector< vector<double> > getWorkDualValues(LiveNurse* pNurse);
-   vector<double> getStartWorkDualValues(LiveNurse* pNurse);
-   vector<double> getEndWorkDualValues(LiveNurse* pNurse);
-   double getWorkedWeekendDualValue(LiveNurse* pNurse);
+   void getNurseDualValues(const DualSnapshot& snapshot, LiveNurse* pNurse, NurseDualValues& duals);
 
    //compute some forbidden shifts from the lasts rotations and forbidden shifts
    //
-   void computeForbiddenShifts(set<pair<int,int> >& forbiddenShifts, vector<Rotation> rotations);
+   void computeForbiddenShifts(DayShiftSet& forbiddenShifts, const vector<Rotation>& rotations);
 };
 
 static bool compareObject(const pair<MyVar*,double>& p1, const pair<MyVar*,double>& p2);
@@ -13,6 +13,40 @@
 #include "MyTools.h"
 #include "Nurse.h"
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   P e n a l t y T a b l e
+//
+//  Penalties of the consecutive shifts, worked days and days off of a contract
+//
+//-----------------------------------------------------------------------------
+
+// Constructor
+//
+PenaltyTable::PenaltyTable(const vector<int>& minConsShifts, const vector<int>& maxConsShifts, const Contract& contract):
+		minConsShifts_(minConsShifts), maxConsShifts_(maxConsShifts),
+		minConsDaysWork_(contract.minConsDaysWork_), maxConsDaysWork_(contract.maxConsDaysWork_),
+		minConsDaysOff_(contract.minConsDaysOff_), maxConsDaysOff_(contract.maxConsDaysOff_){
+
+	for(int sh=0; sh<minConsShifts_.size(); ++sh)
+		consShiftsCosts_.push_back(buildCosts(minConsShifts_[sh], maxConsShifts_[sh], WEIGHT_CONS_SHIFTS));
+	consDaysWorkCosts_ = buildCosts(minConsDaysWork_, maxConsDaysWork_, WEIGHT_CONS_DAYS_WORK);
+	consDaysOffCosts_ = buildCosts(minConsDaysOff_, maxConsDaysOff_, WEIGHT_CONS_DAYS_OFF);
+}
+
+// Fill the penalties of the lengths 0 to max(minCons, maxCons)+1
+//
+vector<double> PenaltyTable::buildCosts(int minCons, int maxCons, int weight){
+	vector<double> costs;
+	for(int n=0; n<=std::max(minCons, maxCons)+1; ++n){
+		if(minCons - n > 0) costs.push_back(weight * (minCons - n));
+		else if(n - maxCons > 0) costs.push_back(weight * (n - maxCons));
+		else costs.push_back(0);
+	}
+	return costs;
+}
+
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   S c e n a r i o
@@ -45,6 +79,13 @@ Scenario::Scenario(string name, int nbWeeks,
 	thisWeek_ = -1;
 	nbWeeksLoaded_ = 1;
 
+	// Build the penalties of the consecutive sequences of each contract
+	//
+	for(int c=0; c<nbContracts_; ++c){
+		const Contract* pContract = contracts_.at(intToContract_[c]);
+		penaltyTables_.push_back(PenaltyTable(minConsShifts_, maxConsShifts_, *pContract));
+	}
+
 	// Preprocess the vector of nurses
 	// This creates the positions
 	//
@@ -34,6 +34,87 @@ static const int WEIGHT_COMPLETE_WEEKEND  = 30;
 static const int WEIGHT_TOTAL_SHIFTS      = 20;
 static const int WEIGHT_TOTAL_WEEKENDS    = 30;
 
+//-----------------------------------------------------------------------------
+//
+//  C l a s s   P e n a l t y T a b l e
+//
+//  Penalties of the consecutive shifts, worked days and days off of a contract
+//  indexed by the length of the sequence. They are computed once per contract
+//  and shared by the pricing, the master problem and the evaluation.
+//
+//-----------------------------------------------------------------------------
+
+class PenaltyTable {
+
+public:
+
+	// Constructor: build the tables for the bounds of the scenario on the
+	// consecutive shifts and for those of the contract
+	//
+	PenaltyTable(const vector<int>& minConsShifts, const vector<int>& maxConsShifts, const Contract& contract);
+
+	// cost of n consecutive assignments to the shift sh, and the part of this
+	// cost due to the minimum (shortage) or to the maximum (excess)
+	//
+	inline double consShiftCost(int sh, int n) const {
+		return cost(consShiftsCosts_[sh], WEIGHT_CONS_SHIFTS, n);
+	}
+	inline double consShiftShortageCost(int sh, int n) const {
+		return (n < minConsShifts_[sh]) ? consShiftCost(sh, n) : 0;
+	}
+	inline double consShiftExcessCost(int sh, int n) const {
+		return (n > maxConsShifts_[sh]) ? consShiftCost(sh, n) : 0;
+	}
+
+	// same for n consecutive worked days
+	//
+	inline double consDaysWorkCost(int n) const {
+		return cost(consDaysWorkCosts_, WEIGHT_CONS_DAYS_WORK, n);
+	}
+	inline double consDaysWorkShortageCost(int n) const {
+		return (n < minConsDaysWork_) ? consDaysWorkCost(n) : 0;
+	}
+	inline double consDaysWorkExcessCost(int n) const {
+		return (n > maxConsDaysWork_) ? consDaysWorkCost(n) : 0;
+	}
+
+	// same for n consecutive days off
+	//
+	inline double consDaysOffCost(int n) const {
+		return cost(consDaysOffCosts_, WEIGHT_CONS_DAYS_OFF, n);
+	}
+	inline double consDaysOffShortageCost(int n) const {
+		return (n < minConsDaysOff_) ? consDaysOffCost(n) : 0;
+	}
+	inline double consDaysOffExcessCost(int n) const {
+		return (n > maxConsDaysOff_) ? consDaysOffCost(n) : 0;
+	}
+
+private:
+
+	// bounds on the lengths of the sequences
+	//
+	vector<int> minConsShifts_, maxConsShifts_;
+	int minConsDaysWork_, maxConsDaysWork_, minConsDaysOff_, maxConsDaysOff_;
+
+	// penalty of a sequence of each length until one day after the maximum
+	//
+	vector< vector<double> > consShiftsCosts_;
+	vector<double> consDaysWorkCosts_, consDaysOffCosts_;
+
+	// fill the penalties of the lengths 0 to max(minCons, maxCons)+1
+	//
+	static vector<double> buildCosts(int minCons, int maxCons, int weight);
+
+	// read the penalty of a length in a table, the longer sequences only
+	// pay one more weight per extra day
+	//
+	static inline double cost(const vector<double>& costs, int weight, int n) {
+		int last = costs.size()-1;
+		return (n <= last) ? costs[n] : costs[last] + (n-last) * weight;
+	}
+};
+
 //-----------------------------------------------------------------------------
 //
 //  C l a s s   S c e n a r i o
@@ -107,6 +188,11 @@ public:
 
 
 private:
+	// Penalties of the consecutive sequences of each contract (indexed by the id of the contract),
+	// read with penaltyTable()
+	//
+	vector<PenaltyTable> penaltyTables_;
+
 	//------------------------------------------------
 	// From the Week data file
 	//------------------------------------------------
@@ -202,6 +288,12 @@ public:
 		return theNurses_[whichNurse].needCompleteWeekends();
 	}
 
+	// getter for the penalties of the consecutive sequences of a contract
+	//
+	const PenaltyTable& penaltyTable(const Contract* pContract) const {
+		return penaltyTables_[pContract->id_];
+	}
+
 	// getters for the attribute of the demand
 	//
 	int nbDays() {return pWeekDemand_->nbDays_;}
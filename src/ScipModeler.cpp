@@ -154,6 +154,21 @@ int ScipModeler::addCoefLinear(MyObject* cons, MyObject* var, double coeff, bool
    SCIP_CALL( SCIPaddCoefLinear(scip_, cons3, var3, coeff) );
 }
 
+/*
+ * Add a block of new columns to the problem
+ */
+
+void ScipModeler::createColumns(const MyColumnBlock& block, vector<MyVar*>& vars){
+   for(int j=0; j<block.size(); ++j){
+      MyObject* var;
+      createVar(&var, block.names_[j].c_str(), block.costs_[j], block.lbs_[j], block.ubs_[j], block.types_[j], 0);
+      SCIP_VAR* var2 = ((ScipVar*) var)->var_;
+      for(int k=block.starts_[j]; k<block.starts_[j+1]; ++k)
+         SCIP_CALL_ABORT( SCIPaddCoefLinear(scip_, ((ScipCons*) block.rows_[k])->cons_, var2, block.coeffs_[k]) );
+      vars.push_back((MyVar*) var);
+   }
+}
+
 /*
  * Get the transformed variables and constraints
  *
@@ -112,6 +112,12 @@ public:
 
    int addCoefLinear(MyObject* cons, MyObject* var, double coeff, bool transformed=false);
 
+   /*
+    * Add a block of new columns to the problem
+    */
+
+   void createColumns(const MyColumnBlock& block, vector<MyVar*>& vars);
+
    /*
     * Get the transformed variables and constraints
     *
@@ -178,7 +178,10 @@ void LiveNurse::checkConstraints(const Roster& roster,
 
   // check the soft constraints and record the costs of the violations and the
   // remaining margin for the satisfied ones.
+  // the maximum consecutive penalties are counted day by day: the cost of the
+  // day is the increase of the excess cost of the sequence
   //
+  const PenaltyTable& penalties = pScenario_->penaltyTable(pContract_);
   for (int day = 1; day <= nbDays_; day++) {
 
     // shift assigned on the previous day
@@ -187,46 +190,43 @@ void LiveNurse::checkConstraints(const Roster& roster,
 
     // first look at consecutive working days or days off
     //
-    int missingDays=0, extraDays=0;
     stat.costConsDays_[day-1] = 0;
     stat.costConsDaysOff_[day-1] = 0;
 
     // compute the violations of consecutive working days an
     if (shift) {
       if (prevShift == 0) {
-        missingDays = minConsDaysOff()-states[day-1].consDaysOff_;
+        stat.costConsDaysOff_[day-1] += penalties.consDaysOffShortageCost(states[day-1].consDaysOff_);
       }
-
-      stat.costConsDaysOff_[day-1] += (missingDays>0) ? WEIGHT_CONS_DAYS_OFF*missingDays:0;
-      stat.costConsDays_[day-1] += (states[day].consDaysWorked_>maxConsDaysWork()) ? WEIGHT_CONS_DAYS_WORK:0;
+      int consDays = states[day].consDaysWorked_;
+      stat.costConsDays_[day-1] +=
+        penalties.consDaysWorkExcessCost(consDays) - penalties.consDaysWorkExcessCost(consDays-1);
     }
     else {
       if (prevShift > 0) {
-        missingDays =minConsDaysWork()-states[day-1].consDaysWorked_;
+        stat.costConsDays_[day-1] += penalties.consDaysWorkShortageCost(states[day-1].consDaysWorked_);
       }
-      extraDays = states[day].consDaysOff_-maxConsDaysOff();
-
-      stat.costConsDays_[day-1] += (missingDays>0) ? WEIGHT_CONS_DAYS_WORK*missingDays:0;
-      stat.costConsDaysOff_[day-1] += (extraDays>0) ? WEIGHT_CONS_DAYS_OFF:0;
+      int consDaysOff = states[day].consDaysOff_;
+      stat.costConsDaysOff_[day-1] +=
+        penalties.consDaysOffExcessCost(consDaysOff) - penalties.consDaysOffExcessCost(consDaysOff-1);
     }
 
     // check the consecutive same shifts
     //
     stat.costConsShifts_[day-1] = 0;
-    int missingShifts = 0;
 
     // count the penalty for minimum consecutive shifts only for the previous day
     // when the new shift is different
     if (shift != prevShift && prevShift > 0)  {
-      missingShifts = pScenario_->minConsShifts_[prevShift]-states[day-1].consShifts_;
-      stat.costConsShifts_[day-1] += (missingShifts>0) ? WEIGHT_CONS_SHIFTS*missingShifts:0;
+      stat.costConsShifts_[day-1] += penalties.consShiftShortageCost(prevShift, states[day-1].consShifts_);
     }
 
     // count the penalty for maximum consecutive shifts when the shift is worked
     // the last day will then be counted
     if (shift > 0) {
+      int consShifts = states[day].consShifts_;
       stat.costConsShifts_[day-1] +=
-        (states[day].consShifts_>pScenario_->maxConsShifts_[shift]) ? WEIGHT_CONS_SHIFTS:0;
+        penalties.consShiftExcessCost(shift, consShifts) - penalties.consShiftExcessCost(shift, consShifts-1);
     }
 
     // check the preferences
@@ -305,6 +305,7 @@ struct PrintSolution{
 //
 //-----------------------------------------------------------------------------
 enum WeightStrategy { MAX, MEAN, RANDOMMEANMAX, BOUNDRATIO, NO_STRAT };
+enum SPPRCAlgorithm { SPPRC_BOOST, SPPRC_DAY_BUCKETS, SPPRC_BIDIRECTIONAL };
 
 class SolverParam{
 
@@ -341,6 +342,24 @@ public:
 	//primal-dual strategy
 	WeightStrategy weightStrategy_ =  NO_STRAT;
 
+	//number of subproblems solved in parallel during the pricing (size of the pool of pricing threads, kept between the pricings)
+	int nbPricingThreads_ = 1;
+
+	//maximal number of labels kept at each node of the rotation network by the restricted pricing stage
+	//(0: the restricted stage keeps all the labels). It never applies to the exact stage, which keeps all the labels
+	int spprcLabelBudget_ = 0;
+
+	//labeling algorithm of the subproblems: generic one of boost, day-bucketed, or bidirectional (day-bucketed forward from the
+	//source and backward from the sinks, joined on the middle day). The restricted stage with a label budget never uses boost
+	SPPRCAlgorithm spprcAlgorithm_ = SPPRC_BOOST;
+
+	//initial smoothing factor of the duals given to the subproblems (0: no smoothing), adjusted automatically
+	double dualSmoothingAlpha_ = 0;
+
+	//branch before the end of the column generation of a node if its lagrangian bound has not improved
+	//for this many pricings (0: never)
+	int lagrangianPlateau_ = 0;
+
 	int verbose_ = 1;
 };
 
@@ -11,6 +11,11 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <limits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
 using std::stringstream;
 using std::vector;
@@ -46,6 +51,68 @@ bool operator<( const spp_spptw_res_cont& res_cont_1, const spp_spptw_res_cont&
 
 
 
+//---------------------------------------------------------------------------
+//
+// C l a s s   L a b e l A r e n a
+//
+//---------------------------------------------------------------------------
+
+LabelArena::LabelArena(size_t blockSize):
+	blockSize_(blockSize), currentBlock_(0), offset_(0), usedMemory_(0) {}
+
+LabelArena::~LabelArena(){
+	for(pair<char*,size_t>& block : blocks_) ::operator delete(block.first);
+}
+
+// Bump allocation in the current block; goes to the next block (or creates one) when it is full
+void* LabelArena::allocate(size_t nBytes, size_t align){
+	while(true){
+		if(currentBlock_ < blocks_.size()){
+			size_t start = (offset_ + align - 1) / align * align;
+			if(start + nBytes <= blocks_[currentBlock_].second){
+				offset_ = start + nBytes;
+				usedMemory_ += nBytes;
+				return blocks_[currentBlock_].first + start;
+			}
+			// The current block is full: try the next one
+			if(offset_ > 0 or blocks_[currentBlock_].second >= nBytes){
+				currentBlock_++;
+				offset_ = 0;
+				continue;
+			}
+		}
+		// No block is large enough: insert a new one at the current position
+		size_t size = max(blockSize_, nBytes);
+		blocks_.insert(blocks_.begin()+currentBlock_, pair<char*,size_t>(static_cast<char*>(::operator new(size)), size));
+		offset_ = 0;
+	}
+}
+
+// Total memory reserved by the arena
+size_t LabelArena::reservedMemory() const{
+	size_t reserved = 0;
+	for(const pair<char*,size_t>& block : blocks_) reserved += block.second;
+	return reserved;
+}
+
+// Sorts the arcs by day-shift of destination (counting sort, the order of the arcs of a day-shift is kept)
+void spp_day_shift_arcs::sortByDayShift(int nDayShifts){
+	firstArc.assign(nDayShifts+1, 0);
+	for(int ds : dayShift) firstArc[ds+1]++;
+	for(int ds=0; ds<nDayShifts; ds++) firstArc[ds+1] += firstArc[ds];
+	vector<int> nextPosition(firstArc.begin(), firstArc.end()-1), order(size());
+	for(int i=0; i<size(); i++) order[nextPosition[dayShift[i]]++] = i;
+	spp_day_shift_arcs sorted;
+	for(int i : order) sorted.push_back(arc[i], dayShift[i], baseCost[i], saturday[i] > 0);
+	arc.swap(sorted.arc);
+	dayShift.swap(sorted.dayShift);
+	baseCost.swap(sorted.baseCost);
+	saturday.swap(sorted.saturday);
+	cost.swap(sorted.cost);
+}
+
+
+
 //---------------------------------------------------------------------------
 //
 // C l a s s   S u b P r o b l e m
@@ -55,29 +122,37 @@ bool operator<( const spp_spptw_res_cont& res_cont_1, const spp_spptw_res_cont&
 //---------------------------------------------------------------------------
 
 // Constructors and destructor
-SubProblem::SubProblem(): rdm_(Tools::getANewRandomGenerator()) {}
+SubProblem::SubProblem(): pPenalties_(0), pTopology_(0), pOwnedTopology_(0), peakLabelMemory_(0), nKBestLabels_(20), labelBudget_(0), nbLabels_(0), pLastCostsNurse_(0), pLastCostsStateIni_(0), nArcsCostUpdated_(0), nArcsCostSkipped_(0),
+	rdm_(Tools::getANewRandomGenerator()) {}
 
-SubProblem::SubProblem(Scenario * scenario, int nbDays, const Contract * contract, vector<State>* pInitState):
-	pScenario_(scenario), pContract_ (contract),
-	CDMin_(contract->minConsDaysWork_), maxRotationLength_(nbDays), nDays_(nbDays),
+SubProblem::SubProblem(Scenario * scenario, int nbDays, const Contract * contract, vector<State>* pInitState, spp_csr_topology* pTopology):
+	pScenario_(scenario), pContract_ (contract), pPenalties_(&scenario->penaltyTable(contract)), pTopology_(0), pOwnedTopology_(0),
+	CDMin_(contract->minConsDaysWork_), maxRotationLength_(nbDays), nDays_(nbDays), peakLabelMemory_(0), nKBestLabels_(20), labelBudget_(0), nbLabels_(0),
+	pLastCostsNurse_(0), pLastCostsStateIni_(0), nArcsCostUpdated_(0), nArcsCostSkipped_(0),
    rdm_(Tools::getANewRandomGenerator()){
 
 	init(pInitState);
 
 	initShortSuccessions();
+	initVeryShortSuccessions();
 
 	createNodes();
 	createArcs();
+	initCsrTopology(pTopology);
+	initDayShiftArcs();
 
 	// Set all arc and node status to authorized
 	for(int v=0; v<nNodes_; v++) nodeStatus_.push_back(true);
 	for(int a=0; a<nArcs_; a++) arcStatus_.push_back(true);
+	isInForbiddenArcs_.assign(nArcs_, false);
+	isEliminatedArc_.assign(nArcs_, false);
 	for(int k=0; k<nDays_; k++){
 		vector<bool> v;
 		for(int s=0; s<pScenario_->nbShifts_; s++)
 			v.push_back(true);
 		dayShiftStatus_.push_back(v);
 	}
+	forbiddenDayShifts_ = DayShiftSet(nDays_, pScenario_->nbShifts_);
 
 	nPathsMin_ = 0;
 
@@ -88,7 +163,9 @@ SubProblem::SubProblem(Scenario * scenario, int nbDays, const Contract * contrac
 
 }
 
-SubProblem::~SubProblem(){}
+SubProblem::~SubProblem(){
+	delete pOwnedTopology_;
+}
 
 // Initialization function
 void SubProblem::init(vector<State>* pInitState){
@@ -268,24 +345,6 @@ void SubProblem::initShortSuccessions(){
 
 }
 
-// Cost function for consecutive identical shifts
-//
-double SubProblem::consShiftCost(int sh, int n){
-	if(pScenario_->minConsShifts_[sh] - n > 0) return (WEIGHT_CONS_SHIFTS * ( pScenario_->minConsShifts_[sh] - n ) );
-	if(n - pScenario_->maxConsShifts_[sh] > 0) return (WEIGHT_CONS_SHIFTS * ( n - pScenario_->maxConsShifts_[sh] ) );
-	return 0;
-}
-
-// Cost function for consecutive identical shifts
-//
-double SubProblem::consDaysCost(int n){
-	if(pContract_->minConsDaysWork_ - n > 0) return (WEIGHT_CONS_DAYS_WORK * ( pContract_->minConsDaysWork_ - n ) );
-	if(n - pContract_->maxConsDaysWork_ > 0) return (WEIGHT_CONS_DAYS_WORK * ( n - pContract_->maxConsDaysWork_ ) );
-	return 0;
-}
-
-
-
 //--------------------------------------------
 //
 // Solve function
@@ -296,23 +355,33 @@ double SubProblem::consDaysCost(int n){
 bool SubProblem::solve(LiveNurse* nurse, DualCosts * costs, vector<SolveOption> options, set<pair<int,int> > forbiddenDayShifts,
 		bool optimality, int maxRotationLength, double redCostBound){
 
+	SolveOptionMask optionMask = 0;
+	for(SolveOption o : options) optionMask |= solveOptionBit(o);
+	return solve(nurse, costs, optionMask, DayShiftSet(nDays_, pScenario_->nbShifts_, forbiddenDayShifts),
+			optimality, maxRotationLength, redCostBound);
+}
+
+// Solve : Returns TRUE if negative reduced costs path were found; FALSE otherwise.
+bool SubProblem::solve(LiveNurse* nurse, DualCosts * costs, SolveOptionMask options, const DayShiftSet& forbiddenDayShifts,
+		bool optimality, int maxRotationLength, double redCostBound){
 
 	bestReducedCost_ = 0;
+	nArcsCostUpdated_ = 0;													// Count the arc costs updated by this solve
+	nArcsCostSkipped_ = 0;
 	setSolveOptions(options);												// Get the parameters informations
 	maxRotationLength_ = min(nDays_+maxOngoingDaysWorked_, max(pContract_->maxConsDaysWork_, maxRotationLength));// Maximum rotation length
 	maxReducedCostBound_ = redCostBound - EPSILON;							// Cost bound
 	pLiveNurse_ = nurse;													// Reset the nurse
 	pCosts_ = costs;														// Reset the costs
-	if(isOptionActive(SOLVE_FORBIDDEN_RESET)) resetAuthorizations();		// Reset authorizations if needed
 	if(isOptionActive(SOLVE_SOLUTIONS_RESET)) resetSolutions();				// Delete all previous solutions if needed
-	set<pair<int,int> > forbiddenDayShiftsUsed = forbiddenDayShifts;		// Forbidden shifts
-	if(isOptionActive(SOLVE_FORBIDDEN_RANDOM))
-		forbiddenDayShiftsUsed = randomForbiddenShifts(25);					// If needed, Generate random forbidden
 	initStructuresForSolve();												// Initialize structures
 	if(isOptionActive(SOLVE_COST_RANDOM)) generateRandomCosts(-50,50);		// If needed, generate other costs
 	nLongFound_=0;															// Initialize number of solutions found at 0 (long rotations)
 	nVeryShortFound_=0;														// Initialize number of solutions found at 0 (short rotations)
-	forbid(forbiddenDayShifts);												// Forbid arcs
+	if(isOptionActive(SOLVE_FORBIDDEN_RANDOM))								// Forbid arcs (if needed, generate random forbidden)
+		forbid(DayShiftSet(nDays_, pScenario_->nbShifts_, randomForbiddenShifts(25)), false);
+	else
+		forbid(forbiddenDayShifts, isOptionActive(SOLVE_FORBIDDEN_KEEP));	// (and the arcs eliminated by reduced cost)
 
 	if(false) printContractAndPrefenrences();								// Set to true if you want to display contract + preferences (for debug)
 
@@ -328,6 +397,7 @@ bool SubProblem::solve(LiveNurse* nurse, DualCosts * costs, vector<SolveOption>
 // For the short rotations, depends on the chosen option + on wether we want optimality (more important)
 bool SubProblem::solveShortRotations(){
 	bool ANS = false;
+	if(!isOptionActive(SOLVE_SHORT_NONE)) initVeryShortCosts();
 	if(isOptionActive(SOLVE_SHORT_DAY_0_AND_LAST_ONLY)){
 		bool tmp_ANS = priceVeryShortRotationsFirstDay();
 		bool tmp_ANS2 = priceVeryShortRotationsLastDay();
@@ -370,9 +440,52 @@ bool SubProblem::solveLongRotationsOptimal(){
 	vector< vector< boost::graph_traits<Graph>::edge_descriptor> > opt_solutions_spptw;
 	vector<spp_spptw_res_cont> pareto_opt_rcs_spptw;
 
+	// All labels of the previous solve are released at once
+	labelArena_.reset();
+	peakLabelMemory_ = 0;
+	nbLabels_ = 0;
+
+	// The maximum rotation length of the solve bounds the time of the labels (the network is the same for all lengths).
+	// Lower bounds on the cost to the sinks: the labels that cannot lead to a rotation of cost lower than maxReducedCostBound_ are dropped
+	vector<int> allSinks;
+	if(isOptionActive(SOLVE_SINGLE_SINKNODE))
+		allSinks.push_back(sinkNode_);
+	else
+		for(int k=CDMin_-1; k<nDays_; k++) allSinks.push_back( sinkNodesByDay_[k] );
+	computeCompletionBounds(networkResources_, allSinks, completionBound_);
+
+	// With option SOLVE_LABELS_KBEST, the boost labeling algorithm stops once enough good labels have reached the sinks.
+	// If it does not stop, the Pareto-fronts are complete: no rotation found still proves optimality
+	vector<bool> isSink(nNodes_, false);
+	for(int t : allSinks) isSink[t] = true;
+	spp_kbest_visitor visitor(&isSink, maxReducedCostBound_, &nbLabels_);
+	if(isOptionActive(SOLVE_LABELS_KBEST)) visitor = spp_kbest_visitor(&isSink, maxReducedCostBound_, &nbLabels_, nKBestLabels_);
+
+	// With option SOLVE_LABELS_BUDGET, the day-bucketed algorithms keep at most labelBudget_ labels per node (heuristic)
+	int labelBudget = isOptionActive(SOLVE_LABELS_BUDGET) ? labelBudget_ : 0;
+
+	// DAY-BUCKETED LABELING ALGORITHM (ONE OR SEVERAL SINKS)
+	//
+	if(isOptionActive(SOLVE_SPPRC_DAY_BUCKETS)){
+		r_c_shortest_paths_day_buckets(networkResources_, completionBound_, maxReducedCostBound_, maxRotationLength_, labelBudget, labelsAtNode_, allSinks,
+				opt_solutions_spptw, pareto_opt_rcs_spptw, nbLabels_);
+		for(const spp_label_bucket& bucket : labelsAtNode_) peakLabelMemory_ += bucket.memory();
+		return addRotationsFromPaths(opt_solutions_spptw, pareto_opt_rcs_spptw);
+	}
+
+	// BIDIRECTIONAL LABELING ALGORITHM (ONE OR SEVERAL SINKS), JOINED ON THE MIDDLE DAY
+	//
+	else if(isOptionActive(SOLVE_SPPRC_BIDIRECTIONAL)){
+		r_c_shortest_paths_bidirectional(networkResources_, completionBound_, maxReducedCostBound_, maxRotationLength_, labelBudget, labelsAtNode_, backwardLabelsAtNode_,
+				allSinks, nDays_/2, opt_solutions_spptw, pareto_opt_rcs_spptw, nbLabels_);
+		for(const spp_label_bucket& bucket : labelsAtNode_) peakLabelMemory_ += bucket.memory();
+		for(const spp_backward_bucket& bucket : backwardLabelsAtNode_) peakLabelMemory_ += bucket.memory();
+		return addRotationsFromPaths(opt_solutions_spptw, pareto_opt_rcs_spptw);
+	}
+
 	// ONE SINGLE SINK FOR ALL DAYS
 	//
-	if(isOptionActive(SOLVE_SINGLE_SINKNODE)){
+	else if(isOptionActive(SOLVE_SINGLE_SINKNODE)){
 		r_c_shortest_paths(
 				g_,
 				get( &Vertex_Properties::num, g_ ),
@@ -382,33 +495,31 @@ bool SubProblem::solveLongRotationsOptimal(){
 				opt_solutions_spptw,
 				pareto_opt_rcs_spptw,
 				spp_spptw_res_cont (0,0),
-				ref_spptw(),
+				ref_spptw(&completionBound_, maxReducedCostBound_, maxRotationLength_),
 				dominance_spptw(),
-				std::allocator< boost::r_c_shortest_paths_label< Graph, spp_spptw_res_cont> >(),
-				boost::default_r_c_shortest_paths_visitor() );
+				LabelArenaAllocator< boost::r_c_shortest_paths_label< Graph, spp_spptw_res_cont> >(),	// boost creates its own allocator: no arena
+				visitor );
 		return addRotationsFromPaths(opt_solutions_spptw, pareto_opt_rcs_spptw);
 	}
 
 	// ONE SINK FOR EACH DAY
 	//
 	else if(isOptionActive(SOLVE_ONE_SINK_PER_LAST_DAY)){
-		std::vector<boost::graph_traits<Graph>::vertex_descriptor> allSinks;
-		for(int k=CDMin_-1; k<nDays_; k++){
-			allSinks.push_back( sinkNodesByDay_[k] );
-		}
+		std::vector<boost::graph_traits<Graph>::vertex_descriptor> sinkVertices(allSinks.begin(), allSinks.end());
 		r_c_shortest_paths_several_sinks(
 				g_,
 				get( &Vertex_Properties::num, g_ ),
 				get( &Arc_Properties::num, g_ ),
 				sourceNode_,
-				allSinks,
+				sinkVertices,
 				opt_solutions_spptw,
 				pareto_opt_rcs_spptw,
 				spp_spptw_res_cont (0,0),
-				ref_spptw(),
+				ref_spptw(&completionBound_, maxReducedCostBound_, maxRotationLength_),
 				dominance_spptw(),
-				std::allocator< boost::r_c_shortest_paths_label< Graph, spp_spptw_res_cont> >(),
-				boost::default_r_c_shortest_paths_visitor() );
+				LabelArenaAllocator< boost::r_c_shortest_paths_label< Graph, spp_spptw_res_cont> >(&labelArena_),
+				visitor );
+		peakLabelMemory_ = labelArena_.usedMemory();
 		return addRotationsFromPaths(opt_solutions_spptw, pareto_opt_rcs_spptw);
 	}
 
@@ -420,10 +531,16 @@ bool SubProblem::solveLongRotationsOptimal(){
 }
 
 // Store the options in a readable way
-void SubProblem::setSolveOptions(vector<SolveOption> options){
+void SubProblem::setSolveOptions(const vector<SolveOption>& options){
+	SolveOptionMask optionMask = 0;
+	for(SolveOption o : options) optionMask |= solveOptionBit(o);
+	setSolveOptions(optionMask);
+}
+
+void SubProblem::setSolveOptions(SolveOptionMask options){
 
 	activeOptions_.assign(100, false);
-	for(SolveOption o : options) activeOptions_[o] = true;
+	for(int o=0; o<64; o++) activeOptions_[o] = (options >> o) & 1;
 
 	// Check for incompatible options...
 	for(vector<SolveOption> cluster : incompatibilityClusters){
@@ -486,14 +603,6 @@ bool SubProblem::addRotationsFromPaths(vector< vector< boost::graph_traits<Graph
 			if( !b_correctly_extended )
 				std::cout << "Not correctly extended." << std::endl;
 		}
-
-		if(resources[p].cost < maxReducedCostBound_){
-			Rotation rot = rotationFromPath(paths[p], resources[p]);
-			theRotations_.push_back(rot);
-			nPaths_ ++;
-			nLongFound_++;
-			nFound ++;
-		}
 	}
 	//printAllRotations();
 //	std::cout << "# -> " << nFound << std::endl;
@@ -502,10 +611,11 @@ bool SubProblem::addRotationsFromPaths(vector< vector< boost::graph_traits<Graph
 
 // Adds a rotation made from the given path to the current list of answers and increases their counter
 //
-Rotation SubProblem::rotationFromPath(vector< boost::graph_traits<Graph>::edge_descriptor > path, spp_spptw_res_cont resource){
+Rotation SubProblem::rotationFromPath(const vector< boost::graph_traits<Graph>::edge_descriptor >& path, const spp_spptw_res_cont& resource){
 
 	int firstDay = -1;
 	vector<int> shiftSuccession;
+	shiftSuccession.reserve(maxRotationLength_);
 
 	// All arcs are consecutively considered
 	//
@@ -517,9 +627,8 @@ Rotation SubProblem::rotationFromPath(vector< boost::graph_traits<Graph>::edge_d
 		// A. Arc from source (equivalent to short rotation
 		if(aType == SOURCE_TO_PRINCIPAL){
 			firstDay =  principalToDay_[destin] - CDMin_ + 1;
-			for(int s: static_cast<vector <int> >( allowedShortSuccBySize_[CDMin_][ shortSuccCDMinIdFromArc_.at(a) ] )){
-				shiftSuccession.push_back(s);
-			}
+			const vector<int>& shortSucc = allowedShortSuccBySize_[CDMin_][ shortSuccCDMinIdFromArc_[a] ];
+			shiftSuccession.insert(shiftSuccession.end(), shortSucc.begin(), shortSucc.end());
 		}
 
 		// B. Arc to a new day
@@ -556,13 +665,14 @@ void SubProblem::createNodes(){
 	int nShifts= pScenario_->nbShifts_;											// Number of different shifts
 
 	// INITIALIZATION
+	// (the network is built for the rotations of at most nDays_ days, whatever the maximum length of the solves)
 	nNodes_ = 0;
 	initNodesStructures();
 
 	// 1. SOURCE NODE
 	//
 	sourceNode_ = nNodes_;
-	addSingleNode(SOURCE_NODE, 0, maxRotationLength_);
+	addSingleNode(SOURCE_NODE, 0, nDays_);
 
 	// 2. PRINCIPAL NETWORK(S) [ONE PER SHIFT TYPE]
 	//
@@ -579,25 +689,25 @@ void SubProblem::createNodes(){
 	// For each of the days, do a rotation-length-checker
 	for(int k=0; k<nDays_; k++){
 		rotationLengthEntrance_.push_back(nNodes_);									// One node for the entrance in subnetwork per day
-		addSingleNode(ROTATION_LENGTH_ENTRANCE, 0, maxRotationLength_);
-		map<int,int> checkNodesForThatDay;
+		addSingleNode(ROTATION_LENGTH_ENTRANCE, 0, nDays_);
+		vector<int> checkNodesForThatDay(nDays_+1, -1);
 		// Check nodes
-		for(int l=CD_max; l<=maxRotationLength_; l++){								// Check nodes: from CD_max (longest free) to maximum rotation length, for each day
-			checkNodesForThatDay.insert(pair<int,int>(l,nNodes_));
-			rotationLengthNodesLAT_.insert(pair<int,int>(nNodes_,l));
+		for(int l=CD_max; l<=nDays_; l++){								// Check nodes: from CD_max (longest free) to maximum rotation length, for each day
+			checkNodesForThatDay[l] = nNodes_;
 			addSingleNode(ROTATION_LENGTH, 0, l);
+			rotationLengthNodesLAT_[checkNodesForThatDay[l]] = l;
 		}
 		rotationLengthNodes_.push_back(checkNodesForThatDay);
 		// Sink day
 		sinkNodesByDay_.push_back(nNodes_);											// Daily sink node
-		addSingleNode(SINK_DAY, 0, maxRotationLength_);
+		addSingleNode(SINK_DAY, 0, nDays_);
 
 	}
 
 	// 4. SINK NODE
 	//
 	sinkNode_ = nNodes_;
-	addSingleNode(SINK_NODE, 0, maxRotationLength_);
+	addSingleNode(SINK_NODE, 0, nDays_);
 }
 
 // Initiate variables for the nodes structures (vectors, etc.)
@@ -643,6 +753,10 @@ void SubProblem::initNodesStructures(){
 void SubProblem::addSingleNode(NodeType type, int eat, int lat){
 	add_vertex( Vertex_Properties( nNodes_, type, eat, lat ), g_ );
 	allNodesTypes_.push_back(type);
+	principalToShift_.push_back(-1);
+	principalToDay_.push_back(-1);
+	principalToCons_.push_back(-1);
+	rotationLengthNodesLAT_.push_back(-1);
 	nNodes_++;
 
 }
@@ -652,18 +766,18 @@ void SubProblem::addNodeToPrincipalNetwork(int sh, int k, int cons){
 
 	// Store its ID in the vector3D
 	//
-	allNodesTypes_.push_back(PRINCIPAL_NETWORK);
-	principalNetworkNodes_[sh][k][cons] = nNodes_;
+	int v = nNodes_;
+	principalNetworkNodes_[sh][k][cons] = v;
 
-	// Store the information backwards
+	// Create the node
 	//
-	principalToShift_.insert(pair<int,int>(nNodes_, sh));
-	principalToDay_.insert(pair<int,int>(nNodes_, k));
-	principalToCons_.insert(pair<int,int>(nNodes_, cons));
+	addSingleNode(PRINCIPAL_NETWORK, 0, nDays_);
 
-	// Create the node
+	// Store the information backwards
 	//
-	addSingleNode(PRINCIPAL_NETWORK, 0, maxRotationLength_);
+	principalToShift_[v] = sh;
+	principalToDay_[v] = k;
+	principalToCons_[v] = cons;
 }
 
 
@@ -680,6 +794,9 @@ void SubProblem::createArcs(){
 	createArcsSourceToPrincipal();
 	createArcsPrincipalToPrincipal();
 	createArcsAllRotationSize();
+
+	// The short succession of each arc from the source is set at each cost update
+	shortSuccCDMinIdFromArc_.assign(nArcs_, -1);
 }
 
 // Adds a single arc (origin, destination, cost, travel time, type)
@@ -724,6 +841,8 @@ void SubProblem::initArcsStructures(){
 	// VECTORS 2 D
 	Tools::initVector2D(&arcsRepeatShift_, pScenario_->nbShifts_, nDays_);
 	Tools::initVector2D(&arcsPrincipalToRotsizein_, pScenario_->nbShifts_, nDays_, -1);
+	Tools::initVector2D(&arcsRotsizeinToRotsizeDay_, nDays_, nDays_+1, -1);
+	Tools::initVector2D(&arcsRotsizeToRotsizeoutDay_, nDays_, nDays_+1, -1);
 
 }
 
@@ -832,25 +951,21 @@ void SubProblem::createArcsAllRotationSize(){
 	//
 	for(int k=CDMin_-1; k<nDays_; k++){
 
-		map<int,int> rotLengthNodesForDay = rotationLengthNodes_[k];
-		map<int,int> arcsRotsizeinToRotsize;
-		map<int,int> arcsRotsizeToRotsizeout;
-		for(map<int,int>::iterator itRLN = rotLengthNodesForDay.begin(); itRLN != rotLengthNodesForDay.end(); ++itRLN){
+		const vector<int>& rotLengthNodesForDay = rotationLengthNodes_[k];
+		for(int l=0; l<rotLengthNodesForDay.size(); l++){
+			if(rotLengthNodesForDay[l] < 0) continue;
 			// From entrance of that day to checknode
 			origin = rotationLengthEntrance_[k];
-			destin = itRLN->second;
-			arcsRotsizeinToRotsize.insert(pair<int,int>(itRLN->first, nArcs_));
-			addSingleArc(origin, destin, consDaysCost(itRLN->first), 0, ROTSIZEIN_TO_ROTSIZE);
+			destin = rotLengthNodesForDay[l];
+			arcsRotsizeinToRotsizeDay_[k][l] = nArcs_;
+			addSingleArc(origin, destin, consDaysCost(l), 0, ROTSIZEIN_TO_ROTSIZE);
 			// From checknode to exit of that day
-			origin = itRLN->second;
+			origin = rotLengthNodesForDay[l];
 			destin = sinkNodesByDay_[k];
-			arcsRotsizeToRotsizeout.insert(pair<int,int>( itRLN->first, nArcs_));
+			arcsRotsizeToRotsizeoutDay_[k][l] = nArcs_;
 			addSingleArc(origin, destin, 0, 0, ROTSIZE_TO_SINK);
 		}
 
-		arcsRotsizeinToRotsizeDay_.push_back(arcsRotsizeinToRotsize);
-		arcsRotsizeToRotsizeoutDay_.push_back(arcsRotsizeToRotsizeout);
-
 		// link all sink nodes to the main sink node
 		origin = sinkNodesByDay_[k];
 		destin = sinkNode_;
@@ -897,17 +1012,8 @@ void SubProblem::initStructuresForSolve(){
 		}
 	}
 
-	// id and arcCost of best succession (given a triplet s,k,n)
-	idBestShortSuccCDMin_.clear();
-	arcCostBestShortSuccCDMin_.clear();
-	for(int s=0; s<pScenario_->nbShifts_; s++){
-		vector2D v2; vector<vector<double> > w2;
-		int n = maxvalConsByShift_[s]+1;
-		Tools::initVector2D(&v2, nDays_, n, -1);
-		idBestShortSuccCDMin_.push_back(v2);
-		Tools::initDoubleVector2D(&w2, nDays_, n, MAX_COST);
-		arcCostBestShortSuccCDMin_.push_back(w2);
-	}
+	// id and arcCost of best succession (given a triplet s,k,n): they are allocated by init() and each of them is
+	// reset by priceShortSucc() when it must be recomputed (kept otherwise, see updateArcCosts())
 
 }
 
@@ -920,6 +1026,15 @@ void SubProblem::priceShortSucc(){
 
 	for(int s=1; s<pScenario_->nbShifts_; s++){
 		for(int k=CDMin_-1; k<nDays_; k++){
+
+			// NOTHING CHANGED FOR THE SUCCESSIONS THAT END ON DAY k: KEEP THE PREVIOUS ONES (THE ARC MAY HAVE BEEN AUTHORIZED SINCE)
+			if(!shortSuccCostChanged_[k]){
+				for(int n=1; n<=maxvalConsByShift_[s]; n++)
+					if(arcCostBestShortSuccCDMin_[s][k][n] >= MAX_COST-1)
+						forbidArc( arcsFromSource_[s][k][n] );
+				continue;
+			}
+
 			for(int n=1; n<=maxvalConsByShift_[s]; n++){
 
 				idBestShortSuccCDMin_[s][k][n] = -1;
@@ -1013,21 +1128,18 @@ double SubProblem::costArcShortSucc(int size, int succId, int startDate){
 
 		// 1. The nurse was resting: pay more only if the rest is too short
 		if(shiftIni == 0){
-			int diffRest = pLiveNurse_->minConsDaysOff() - pLiveNurse_->pStateIni_->consDaysOff_;
-			ANS += max(0, diffRest*WEIGHT_CONS_DAYS_OFF);
+			ANS += pPenalties_->consDaysOffShortageCost(pLiveNurse_->pStateIni_->consDaysOff_);
 		}
 
 		// 2. The nurse was working
 		else {
 
 			// a. If the number of consecutive days worked has already exceeded the max, subtract now the cost that will be read later
-			int diffWork = nConsWorkIni - pContract_->maxConsDaysWork_;
-			ANS -= max(0, diffWork*WEIGHT_CONS_DAYS_WORK);
+			ANS -= pPenalties_->consDaysWorkExcessCost(nConsWorkIni);
 
 			// b. (i)   The nurse was working on a different shift: if too short, add the corresponding cost
 			if(shiftIni != firstShift){
-				int diff = pScenario_->minConsShifts_[shiftIni] - nConsShiftIni;
-				ANS += max(0, diff*(WEIGHT_CONS_SHIFTS));
+				ANS += pPenalties_->consShiftShortageCost(shiftIni, nConsShiftIni);
 			}
 
 			// b. (ii)  The nurse was working on the same shift AND the short rotation contains other shifts (easy case for add/subtract)
@@ -1035,8 +1147,7 @@ double SubProblem::costArcShortSucc(int size, int succId, int startDate){
 			//            - Subtract the cost due to the consecutive end of the initial state
 			//            - Add the consecutive cost for all shifts
 			else if(nConsFirstShift < CDMin_) {
-				int diffShift = nConsShiftIni - pScenario_->maxConsShifts_[shiftIni];
-				ANS -= max(0, diffShift*WEIGHT_CONS_SHIFTS);
+				ANS -= pPenalties_->consShiftExcessCost(shiftIni, nConsShiftIni);
 				ANS -= consShiftCost(firstShift, nConsFirstShift);
 				ANS += consShiftCost(firstShift, (nConsFirstShift + nConsShiftIni));
 			}
@@ -1090,18 +1201,24 @@ double SubProblem::costArcShortSucc(int size, int succId, int startDate){
 //
 void SubProblem::updateArcCosts(){
 
+	// Only the arcs whose costs depend on changed duals are updated
+	markChangedCosts();
+
 	priceShortSucc();
 
 	// A. ARCS : SOURCE_TO_PRINCIPAL [baseCost = 0]
 	//
-	shortSuccCDMinIdFromArc_.clear();
 	for(int s=1; s<pScenario_->nbShifts_; s++){
 		for(int k=CDMin_-1; k<nDays_; k++){
 			for(int n=1; n<=maxvalConsByShift_[s]; n++){
 				int a = arcsFromSource_[s][k][n];
-				double c = arcCostBestShortSuccCDMin_[s][k][n];
-				updateCost( a , c );
-				shortSuccCDMinIdFromArc_.insert(pair<int,int>( arcsFromSource_[s][k][n], idBestShortSuccCDMin_[s][k][n]));
+				if(shortSuccCostChanged_[k]){
+					double c = arcCostBestShortSuccCDMin_[s][k][n];
+					updateCost( a , c );
+					nArcsCostUpdated_++;
+				}
+				else nArcsCostSkipped_++;
+				shortSuccCDMinIdFromArc_[a] = idBestShortSuccCDMin_[s][k][n];
 			}
 		}
 
@@ -1115,53 +1232,30 @@ void SubProblem::updateArcCosts(){
 		}
 	}
 
-	// B. ARCS : SHIFT_TO_NEWSHIFT [baseCost = 0]
+	// B, C, E. ARCS : SHIFT_TO_NEWSHIFT, SHIFT_TO_SAMESHIFT [baseCost = 0], REPEATSHIFT [baseCost contains consecutive shift cost]
+	// (cost = baseCost + preference - dual cost of the destination day-shift - weekend dual cost if Saturday)
 	//
-	for(int s1=1; s1<pScenario_->nbShifts_; s1++)
-		for(int s2=1; s2<pScenario_->nbShifts_; s2++)
-			for(int k=CDMin_-1; k<nDays_-1; k++){
-				int a = arcsShiftToNewShift_[s1][s2][k];
-				if(a > 0){
-					double c = arcBaseCost_[a];
-					c += preferencesCosts_[k+1][s2] ;
-					c -= pCosts_->dayShiftWorkCost(k+1,s2-1);
-					c -= Tools::isSaturday(k+1) ? pCosts_->workedWeekendCost() : 0 ;
-					updateCost( a , c );
-				}
-			}
-
-	// C. ARCS : SHIFT_TO_SAMESHIFT [baseCost = 0]
-	//
-	for(int s=1; s<pScenario_->nbShifts_; s++)
-		for(int k=CDMin_-1; k<nDays_-1; k++)
-			for(int n=1; n<maxvalConsByShift_[s]; n++){
-				int a = arcsShiftToSameShift_[s][k][n];
-				double c = arcBaseCost_[a];
-				c += preferencesCosts_[k+1][s] ;
-				c -= pCosts_->dayShiftWorkCost(k+1,s-1);
-				if(Tools::isSaturday(k+1)) c-= pCosts_->workedWeekendCost();
-				updateCost( a , c );
-			}
+	int nShifts = pScenario_->nbShifts_;
+	dayShiftArcCosts_.assign(nDays_*nShifts, 0);
+	for(int k=0; k<nDays_; k++)
+		for(int s=1; s<nShifts; s++)
+			dayShiftArcCosts_[k*nShifts+s] = preferencesCosts_[k][s] - pCosts_->dayShiftWorkCost(k,s-1);
+	updateDayShiftArcCosts(newShiftArcs_);
+	updateDayShiftArcCosts(sameShiftArcs_);
+	updateDayShiftArcCosts(repeatShiftArcs_);
 
 	// D. ARCS : SHIFT_TO_ENDSEQUENCE [They never change]
 
-	// E. ARCS : REPEATSHIFT [baseCost contains consecutive shift cost]
-	//
-	for(int s=1; s<pScenario_->nbShifts_; s++)
-		for(int k=CDMin_-1; k<nDays_-1; k++){
-			int a = arcsRepeatShift_[s][k];
-			double c = arcBaseCost_[a];
-			c += preferencesCosts_[k+1][s];
-			c -= pCosts_->dayShiftWorkCost(k+1,s-1);
-			if(Tools::isSaturday(k+1)) c-= pCosts_->workedWeekendCost();
-			updateCost( a , c );
-		}
-
 	// F. ARCS : PRINCIPAL_TO_ROTSIZE [baseCost contains complete weekend constraint]
 	//
 	for(int s=1; s<pScenario_->nbShifts_; s++)
 		for(int k=CDMin_-1; k<nDays_; k++){
 			int a = arcsPrincipalToRotsizein_[s][k];
+			if(!endCostChanged_[k]){
+				nArcsCostSkipped_++;
+				continue;
+			}
+			nArcsCostUpdated_++;
 			double c = arcBaseCost_[a];
 			c += endWeekendCosts_[k];
 			c -= pCosts_->endWorkCost(k);
@@ -1175,6 +1269,182 @@ void SubProblem::updateArcCosts(){
 	// I. ARCS : ROTSIZEOUT_TO_SINK [Never changes]
 }
 
+// Computes cost[i] = baseCost[i] + dayShiftCosts[dayShift[i]] - saturday[i] * weekendCost for the n arcs
+// (gather + FMA, four arcs at a time when compiled with AVX2, i.e. make USE_AVX2=TRUE)
+static void computeDayShiftArcCosts(const double* baseCost, const int* dayShift, const double* saturday, const double* dayShiftCosts,
+		double weekendCost, int n, double* cost){
+	int i=0;
+#if defined(__AVX2__)
+	__m256d w4 = _mm256_set1_pd(weekendCost);
+	for(; i+4<=n; i+=4){
+		__m256d c4 = _mm256_add_pd( _mm256_loadu_pd(baseCost+i),
+				_mm256_i32gather_pd( dayShiftCosts, _mm_loadu_si128( (const __m128i*) (dayShift+i) ), 8 ) );
+#if defined(__FMA__)
+		c4 = _mm256_fnmadd_pd( _mm256_loadu_pd(saturday+i), w4, c4 );
+#else
+		c4 = _mm256_sub_pd( c4, _mm256_mul_pd( _mm256_loadu_pd(saturday+i), w4 ) );
+#endif
+		_mm256_storeu_pd(cost+i, c4);
+	}
+#endif
+	// Scalar version (remaining arcs)
+	for(; i<n; i++)
+		cost[i] = baseCost[i] + dayShiftCosts[dayShift[i]] - saturday[i] * weekendCost;
+}
+
+// Computes and updates the costs of the arcs of the given type whose day-shift cost changed
+// (the arcs are sorted by day-shift: the costs are computed on each run of consecutive changed day-shifts)
+//
+void SubProblem::updateDayShiftArcCosts(spp_day_shift_arcs& arcs){
+	int nShifts = pScenario_->nbShifts_, nDayShifts = arcs.firstArc.size()-1;
+	for(int ds=0; ds<nDayShifts; ){
+		if(!dayShiftCostChanged_[ds/nShifts][ds%nShifts]){
+			nArcsCostSkipped_ += arcs.firstArc[ds+1] - arcs.firstArc[ds];
+			ds++;
+			continue;
+		}
+		int end = ds+1;
+		while(end < nDayShifts and dayShiftCostChanged_[end/nShifts][end%nShifts]) end++;
+		int first = arcs.firstArc[ds], n = arcs.firstArc[end] - first;
+		computeDayShiftArcCosts(arcs.baseCost.data()+first, arcs.dayShift.data()+first, arcs.saturday.data()+first,
+				dayShiftArcCosts_.data(), pCosts_->workedWeekendCost(), n, arcs.cost.data()+first);
+		for(int i=first; i<first+n; i++)
+			updateCost( arcs.arc[i], arcs.cost[i] );
+		nArcsCostUpdated_ += n;
+		ds = end;
+	}
+}
+
+// Stores the arcs whose costs only depend on the day-shift of their destination in contiguous arrays,
+// sorted by day-shift of destination
+//
+void SubProblem::initDayShiftArcs(){
+	int nShifts = pScenario_->nbShifts_;
+	newShiftArcs_ = spp_day_shift_arcs();
+	sameShiftArcs_ = spp_day_shift_arcs();
+	repeatShiftArcs_ = spp_day_shift_arcs();
+	for(int s1=1; s1<nShifts; s1++)
+		for(int s2=1; s2<nShifts; s2++)
+			for(int k=CDMin_-1; k<nDays_-1; k++){
+				int a = arcsShiftToNewShift_[s1][s2][k];
+				if(a > 0) newShiftArcs_.push_back(a, (k+1)*nShifts+s2, arcBaseCost_[a], Tools::isSaturday(k+1));
+			}
+	for(int s=1; s<nShifts; s++)
+		for(int k=CDMin_-1; k<nDays_-1; k++)
+			for(int n=1; n<maxvalConsByShift_[s]; n++){
+				int a = arcsShiftToSameShift_[s][k][n];
+				sameShiftArcs_.push_back(a, (k+1)*nShifts+s, arcBaseCost_[a], Tools::isSaturday(k+1));
+			}
+	for(int s=1; s<nShifts; s++)
+		for(int k=CDMin_-1; k<nDays_-1; k++){
+			int a = arcsRepeatShift_[s][k];
+			repeatShiftArcs_.push_back(a, (k+1)*nShifts+s, arcBaseCost_[a], Tools::isSaturday(k+1));
+		}
+	newShiftArcs_.sortByDayShift(nDays_*nShifts);
+	sameShiftArcs_.sortByDayShift(nDays_*nShifts);
+	repeatShiftArcs_.sortByDayShift(nDays_*nShifts);
+}
+
+// Marks the costs that changed since the last update of the arc costs for the nurse, and stores the new ones.
+// The costs of the arcs of the last nurse are stored and those of the current nurse are restored if it has already been
+// priced with this subproblem: the previous costs can be kept if its initial state did not change.
+//
+void SubProblem::markChangedCosts(){
+
+	int nShifts = pScenario_->nbShifts_;
+	bool randomCosts = isOptionActive(SOLVE_COST_RANDOM);
+	if(!randomCosts and pLastCostsNurse_ != pLiveNurse_){
+		if(pLastCostsNurse_) saveNurseCosts(nurseCosts_[pLastCostsNurse_]);
+		map<LiveNurse*, spp_nurse_costs>::const_iterator it = nurseCosts_.find(pLiveNurse_);
+		if(it != nurseCosts_.end()) loadNurseCosts(it->second);
+		else pLastCostsStateIni_ = 0;
+		pLastCostsNurse_ = pLiveNurse_;
+	}
+	bool keepPrevious = !randomCosts and pLastCostsNurse_ == pLiveNurse_ and pLastCostsStateIni_ == pLiveNurse_->pStateIni_;
+
+	// First call or new nurse: everything must be computed
+	if(!keepPrevious){
+		Tools::initDoubleVector2D(&lastWorkCosts_, nDays_, nShifts);
+		Tools::initDoubleVector(&lastStartWorkCosts_, nDays_);
+		Tools::initDoubleVector(&lastEndWorkCosts_, nDays_);
+		lastDayShiftStatus_ = dayShiftStatus_;
+	}
+	dayShiftCostChanged_.assign(nDays_, vector<bool>(nShifts, !keepPrevious));
+	startCostChanged_.assign(nDays_, !keepPrevious);
+	endCostChanged_.assign(nDays_, !keepPrevious);
+
+	// Compare the costs with those used at the last update
+	// (only the changed costs are stored, so that small changes cannot add up)
+	bool weekendChanged = !keepPrevious or fabs(pCosts_->workedWeekendCost() - lastWorkedWeekendCost_) > DUAL_COST_TOLERANCE;
+	if(weekendChanged) lastWorkedWeekendCost_ = pCosts_->workedWeekendCost();
+	for(int k=0; k<nDays_; k++){
+		if(!keepPrevious or fabs(pCosts_->startWorkCost(k) - lastStartWorkCosts_[k]) > DUAL_COST_TOLERANCE){
+			startCostChanged_[k] = true;
+			lastStartWorkCosts_[k] = pCosts_->startWorkCost(k);
+		}
+		if(!keepPrevious or fabs(pCosts_->endWorkCost(k) - lastEndWorkCosts_[k]) > DUAL_COST_TOLERANCE){
+			endCostChanged_[k] = true;
+			lastEndWorkCosts_[k] = pCosts_->endWorkCost(k);
+		}
+		for(int s=1; s<nShifts; s++){
+			if(!keepPrevious or fabs(pCosts_->dayShiftWorkCost(k,s-1) - lastWorkCosts_[k][s]) > DUAL_COST_TOLERANCE){
+				dayShiftCostChanged_[k][s] = true;
+				lastWorkCosts_[k][s] = pCosts_->dayShiftWorkCost(k,s-1);
+			}
+			// The forbidden day-shifts change the short successions that may be used
+			if(dayShiftStatus_[k][s] != lastDayShiftStatus_[k][s]) dayShiftCostChanged_[k][s] = true;
+			// The weekend cost is paid when working on Saturday (or Sunday for the short successions)
+			if(weekendChanged and Tools::isWeekend(k)) dayShiftCostChanged_[k][s] = true;
+		}
+	}
+	lastDayShiftStatus_ = dayShiftStatus_;
+
+	// A short succession that ends on day k depends on all days of the succession, and on its first day
+	shortSuccCostChanged_.assign(nDays_, !keepPrevious);
+	for(int k=CDMin_-1; k<nDays_; k++){
+		int firstDay = k-CDMin_+1;
+		if(startCostChanged_[firstDay]) shortSuccCostChanged_[k] = true;
+		for(int d=firstDay; d<=k; d++)
+			for(int s=1; s<nShifts; s++)
+				if(dayShiftCostChanged_[d][s]) shortSuccCostChanged_[k] = true;
+	}
+
+	pLastCostsNurse_ = randomCosts ? 0 : pLiveNurse_;
+	pLastCostsStateIni_ = pLiveNurse_->pStateIni_;
+}
+
+// Stores the costs of the arcs of the last nurse, and the duals and forbidden day-shifts they have been computed with
+//
+void SubProblem::saveNurseCosts(spp_nurse_costs& nurseCosts){
+	nurseCosts.pStateIni = pLastCostsStateIni_;
+	nurseCosts.workCosts = lastWorkCosts_;
+	nurseCosts.startWorkCosts = lastStartWorkCosts_;
+	nurseCosts.endWorkCosts = lastEndWorkCosts_;
+	nurseCosts.workedWeekendCost = lastWorkedWeekendCost_;
+	nurseCosts.dayShiftStatus = lastDayShiftStatus_;
+	nurseCosts.arcCost = networkResources_.arcCost;
+	nurseCosts.idBestShortSuccCDMin = idBestShortSuccCDMin_;
+	nurseCosts.arcCostBestShortSuccCDMin = arcCostBestShortSuccCDMin_;
+	nurseCosts.shortSuccCDMinIdFromArc = shortSuccCDMinIdFromArc_;
+}
+
+// Restores the costs of the arcs of the current nurse (only those that differ from the ones of the last nurse are set in the graph)
+//
+void SubProblem::loadNurseCosts(const spp_nurse_costs& nurseCosts){
+	pLastCostsStateIni_ = nurseCosts.pStateIni;
+	lastWorkCosts_ = nurseCosts.workCosts;
+	lastStartWorkCosts_ = nurseCosts.startWorkCosts;
+	lastEndWorkCosts_ = nurseCosts.endWorkCosts;
+	lastWorkedWeekendCost_ = nurseCosts.workedWeekendCost;
+	lastDayShiftStatus_ = nurseCosts.dayShiftStatus;
+	for(int a=0; a<nArcs_; a++)
+		if(networkResources_.arcCost[a] != nurseCosts.arcCost[a])
+			updateCost(a, nurseCosts.arcCost[a]);
+	idBestShortSuccCDMin_ = nurseCosts.idBestShortSuccCDMin;
+	arcCostBestShortSuccCDMin_ = nurseCosts.arcCostBestShortSuccCDMin;
+	shortSuccCDMinIdFromArc_ = nurseCosts.shortSuccCDMinIdFromArc;
+}
+
 // Returns true if the given successions contains the given shift
 //
 bool SubProblem::succContainsDayShift(int size, int succId, int startDate, int thatDay, int thatShift){
@@ -1187,13 +1457,14 @@ bool SubProblem::succContainsDayShift(int size, int succId, int startDate, int t
 //
 void SubProblem::generateRandomCosts(double minVal, double maxVal){
 
-	vector<vector<double> > randomWorkCosts = Tools::randomDoubleVector2D(nDays_, pScenario_->nbShifts_, minVal, maxVal);
-	vector<double> randomStartWorkCosts = Tools::randomDoubleVector(nDays_, minVal, maxVal);
-	vector<double> randomEndWorkCosts = Tools::randomDoubleVector(nDays_, minVal, maxVal);
+	randomWorkCosts_ = Tools::randomDoubleVector(nDays_*pScenario_->nbShifts_, minVal, maxVal);
+	randomStartWorkCosts_ = Tools::randomDoubleVector(nDays_, minVal, maxVal);
+	randomEndWorkCosts_ = Tools::randomDoubleVector(nDays_, minVal, maxVal);
 	double randomWorkedWeekendCost = (maxVal - minVal) * ( (double)rdm_() / (double)RAND_MAX ) + minVal;
 
-	bool doNotCopy = false;
-	pCosts_ = new DualCosts(randomWorkCosts, randomStartWorkCosts, randomEndWorkCosts, randomWorkedWeekendCost, doNotCopy);
+	// The costs are kept in the subproblem: the DualCosts is only a view over them
+	pCosts_ = new DualCosts(randomWorkCosts_.data(), pScenario_->nbShifts_, 0, randomStartWorkCosts_.data(),
+			randomEndWorkCosts_.data(), randomWorkedWeekendCost);
 
 }
 
@@ -1221,12 +1492,41 @@ bool SubProblem::canSuccStartHere(vector<int> succ, int firstDay){
 	return true;
 }
 
-// Forbids the nodes that correspond to forbidden shifts
+// Forbids the nodes that correspond to forbidden shifts, and the arcs eliminated by reduced cost. Only the day-shifts and
+// the arcs whose status changes are touched: those that are forbidden for the first time, and (unless the forbidden ones
+// are kept) those that are not forbidden anymore
 //
-void SubProblem::forbid(set<pair<int,int> > forbiddenDayShifts){
-	for(pair<int,int> p : forbiddenDayShifts){
-		//std::cout << "# Trying to forbid " << p.first << "-" << pScenario_->intToShift_[p.second].at(0) << endl;
-		forbidDayShift(p.first,p.second);
+void SubProblem::forbid(const DayShiftSet& forbiddenDayShifts, bool keepForbidden){
+
+	// The arcs forbidden since the last reset (short successions, reduced cost) are authorized again, except those that
+	// are still eliminated
+	if(!keepForbidden){
+		for(int a : eliminatedArcs_) isEliminatedArc_[a] = true;
+		int nKept = 0;
+		for(int a : forbiddenArcs_){
+			if(isEliminatedArc_[a]){
+				forbiddenArcs_[nKept++] = a;
+				continue;
+			}
+			authorizeArc(a);
+			isInForbiddenArcs_[a] = false;
+		}
+		forbiddenArcs_.resize(nKept);
+		for(int a : eliminatedArcs_) isEliminatedArc_[a] = false;
+	}
+	for(int a : eliminatedArcs_) forbidArc(a);
+
+	int nShifts = pScenario_->nbShifts_;
+	for(int w=0; w<forbiddenDayShifts.words_.size(); w++){
+		uint64_t newWord = forbiddenDayShifts.words_[w];
+		uint64_t& curWord = forbiddenDayShifts_.words_[w];
+		uint64_t diff = keepForbidden ? (newWord & ~curWord) : (newWord ^ curWord);
+		while(diff){
+			int b = w*64 + __builtin_ctzll(diff);
+			diff &= diff-1;
+			if(forbiddenDayShifts.contains(b/nShifts, b%nShifts)) forbidDayShift(b/nShifts, b%nShifts);
+			else authorizeDayShift(b/nShifts, b%nShifts);
+		}
 	}
 }
 
@@ -1236,6 +1536,10 @@ void SubProblem::forbidArc(int a){
 	if(!isArcForbidden(a)){
 		arcStatus_[a] = false;
 		updateTime(a,MAX_TIME);
+		if(!isInForbiddenArcs_[a]){
+			isInForbiddenArcs_[a] = true;
+			forbiddenArcs_.push_back(a);
+		}
 	}
 }
 
@@ -1262,8 +1566,8 @@ void SubProblem::authorizeArc(int a){
 //
 void SubProblem::authorizeNode(int v){
 	nodeStatus_[v] = true;
-	int lat = maxRotationLength_;
-	if(nodeType(v) == ROTATION_LENGTH) lat = rotationLengthNodesLAT_.at(v);
+	int lat = nDays_;
+	if(nodeType(v) == ROTATION_LENGTH) lat = rotationLengthNodesLAT_[v];
 	updateLat(v,lat);
 }
 
@@ -1287,6 +1591,7 @@ int SubProblem::normalTravelTime(int a){
 void SubProblem::forbidDayShift(int k, int s){
 	// Mark the day-shift as forbidden
 	dayShiftStatus_[k][s] = false;
+	forbiddenDayShifts_.insert(k,s);
 	// Forbid arcs from principal network corresponding to that day-shift only if k >= CDMin_
 	if(k >= CDMin_-1){
 		for(int n=1; n<=maxvalConsByShift_[s]; n++){
@@ -1297,8 +1602,9 @@ void SubProblem::forbidDayShift(int k, int s){
 
 // (re)Authorizes the day-shift couple BUT does not take it into account in the short rotation pricer (too complicated, will be called in the next solve() anyway)
 void SubProblem::authorizeDayShift(int k, int s){
-	// Mark the day-shift as forbidden
+	// Mark the day-shift as authorized
 	dayShiftStatus_[k][s] = true;
+	forbiddenDayShifts_.erase(k,s);
 	// Authorize arcs from principal network corresponding to that day-shift
 	if(k >= CDMin_-1){
 		for(int n=1; n<=maxvalConsByShift_[s]; n++)
@@ -1306,17 +1612,6 @@ void SubProblem::authorizeDayShift(int k, int s){
 	}
 }
 
-// Reset all authorizations to true
-//
-void SubProblem::resetAuthorizations(){
-	for(int s=1; s<pScenario_->nbShifts_; s++)
-		for(int k=0; k<nDays_; k++)
-			authorizeDayShift(k,s);
-
-	for(int a=0; a<nArcs_; a++)
-		authorizeArc(a);
-}
-
 // Generate random forbidden shifts
 set< pair<int,int> > SubProblem::randomForbiddenShifts(int nbForbidden){
 	set< pair<int,int> > ans;
@@ -1352,45 +1647,90 @@ int SubProblem::mapAntecedent(map<int,int> m, int val){
 //
 //----------------------------------------------------------------
 
-// Brutally try all possible short rotations from the very first day
-bool SubProblem::priceVeryShortRotationsFirstDay(){
-	int nFound = 0;
+// Decomposes the very short successions in runs of identical shifts, and computes their costs that do not depend on their dates
+void SubProblem::initVeryShortSuccessions(){
+	veryShortSuccs_.clear();
+	veryShortRuns_.clear();
 	for(int c=1; c<CDMin_; c++){
-		vector2D succs = allowedShortSuccBySize_[c];
-		for(int i=0; i<succs.size(); i++){
-			vector<int> succ = allowedShortSuccBySize_[c][i];
-			double redCost = costOfVeryShortRotation(0,succ);
-			int rotationLength = succ.size() + (pLiveNurse_->pStateIni_->shift_ > 0 ? pLiveNurse_->pStateIni_->consDaysWorked_ : 0);
-			if(redCost < maxReducedCostBound_ and rotationLength <= maxRotationLength_){
-				Rotation rot (0, succ, pLiveNurse_, MAX_COST, redCost);
-				theRotations_.push_back(rot);
-				nPaths_ ++;
-				nVeryShortFound_++;
-				nFound ++;
-				bestReducedCost_ = min(bestReducedCost_, rot.dualCost_);
+		for(int i=0; i<allowedShortSuccBySize_[c].size(); i++){
+			const vector<int>& shifts = allowedShortSuccBySize_[c][i];
+			VeryShortSucc succ;
+			succ.size_ = c;
+			succ.id_ = i;
+			succ.firstRun_ = veryShortRuns_.size();
+			// the rest before the succession ends with its first shift
+			succ.innerConsShiftsCost_ = consShiftCost(0, 0);
+			for(int k=0; k<c; k++){
+				if(k > 0 and shifts[k] == shifts[k-1]){
+					veryShortRuns_.back().length_ ++;
+					continue;
+				}
+				if(k > 0) succ.innerConsShiftsCost_ += consShiftCost(veryShortRuns_.back().shift_, veryShortRuns_.back().length_);
+				ShiftRun run = {shifts[k], k, 1};
+				veryShortRuns_.push_back(run);
 			}
+			succ.nRuns_ = veryShortRuns_.size() - succ.firstRun_;
+			const ShiftRun& lastRun = veryShortRuns_.back();
+			succ.lastRunCost_ = consShiftCost(lastRun.shift_, lastRun.length_);
+			succ.lastRunExcessCost_ = pPenalties_->consShiftExcessCost(lastRun.shift_, lastRun.length_);
+			succ.consDaysCost_ = consDaysCost(c);
+			veryShortSuccs_.push_back(succ);
 		}
 	}
+}
+
+// Fills the prefix sums of the day-shift costs and the date costs of the very short rotations for the current costs.
+// Called once per solve, before pricing the very short rotations.
+void SubProblem::initVeryShortCosts(){
+	int nShifts = pScenario_->nbShifts_;
+	dayShiftCostPrefix_.assign(nShifts*(nDays_+1), 0);
+	for(int s=1; s<nShifts; s++){
+		double* prefix = &dayShiftCostPrefix_[s*(nDays_+1)];
+		for(int k=0; k<nDays_; k++)
+			prefix[k+1] = prefix[k] + preferencesCosts_[k][s] - pCosts_->dayShiftWorkCost(k,s-1);
+	}
+	veryShortDateCosts_.assign(max(CDMin_,1)*(nDays_+1), 0);
+	for(int c=1; c<CDMin_; c++)
+		for(int k=0; k+c<=nDays_; k++){
+			int endDate = k+c-1;
+			veryShortDateCosts_[c*(nDays_+1)+k] = startWeekendCosts_[k] + endWeekendCosts_[endDate]
+				- Tools::containsWeekend(k, endDate) * pCosts_->workedWeekendCost()
+				- pCosts_->startWorkCost(k) - pCosts_->endWorkCost(endDate);
+		}
+}
+
+// Record a very short rotation if its reduced cost is good enough
+bool SubProblem::addVeryShortRotation(int firstDay, const VeryShortSucc& succ, double redCost){
+	if(redCost >= maxReducedCostBound_)
+		return false;
+	Rotation rot (firstDay, allowedShortSuccBySize_[succ.size_][succ.id_], pLiveNurse_, MAX_COST, redCost);
+	theRotations_.push_back(rot);
+	nPaths_ ++;
+	nVeryShortFound_++;
+	bestReducedCost_ = min(bestReducedCost_, rot.dualCost_);
+	return true;
+}
+
+// Brutally try all possible short rotations from the very first day
+bool SubProblem::priceVeryShortRotationsFirstDay(){
+	int nFound = 0;
+	int nDaysBefore = pLiveNurse_->pStateIni_->shift_ > 0 ? pLiveNurse_->pStateIni_->consDaysWorked_ : 0;
+	for(const VeryShortSucc& succ: veryShortSuccs_){
+		if(succ.size_ + nDaysBefore > maxRotationLength_)
+			continue;
+		if(addVeryShortRotation(0, succ, costOfVeryShortRotation(0, succ)))
+			nFound ++;
+	}
 	return nFound > 0;
 }
 
 // Brutally try all possible short rotations that end on the last day
 bool SubProblem::priceVeryShortRotationsLastDay(){
 	int nFound = 0;
-	for(int c=1; c<CDMin_; c++){
-		vector2D succs = allowedShortSuccBySize_[c];
-		for(int i=0; i<succs.size(); i++){
-			vector<int> succ = allowedShortSuccBySize_[c][i];
-			double redCost = costOfVeryShortRotation( nDays_-c ,succ);
-			if(redCost < maxReducedCostBound_){
-				Rotation rot (nDays_-c, succ, pLiveNurse_, MAX_COST, redCost);
-				theRotations_.push_back(rot);
-				nPaths_ ++;
-				nVeryShortFound_++;
-				nFound ++;
-				bestReducedCost_ = min(bestReducedCost_, rot.dualCost_);
-			}
-		}
+	for(const VeryShortSucc& succ: veryShortSuccs_){
+		int firstDay = nDays_ - succ.size_;
+		if(addVeryShortRotation(firstDay, succ, costOfVeryShortRotation(firstDay, succ)))
+			nFound ++;
 	}
 	return nFound > 0;
 }
@@ -1398,29 +1738,72 @@ bool SubProblem::priceVeryShortRotationsLastDay(){
 // Brutally try all possible short rotations from every first day
 bool SubProblem::priceVeryShortRotations(){
 	int nFound = 0;
-	for(int c=1; c<CDMin_; c++){
-		vector2D succs = allowedShortSuccBySize_[c];
-		for(int i = 0; i<succs.size(); i++){
-			vector<int> succ = allowedShortSuccBySize_[c][i];
-			for(int k=0; k <= nDays_ - c; k++){
-				//cout << "# " << k << " - " << (k+c-1) << "    [c=" << c << "]" << endl;
-				double redCost = costOfVeryShortRotation(k,succ);
-				if(redCost < maxReducedCostBound_){
-					Rotation rot (k, succ, pLiveNurse_, MAX_COST, redCost);
-					theRotations_.push_back(rot);
-					nPaths_ ++;
-					nVeryShortFound_++;
-					nFound ++;
-					bestReducedCost_ = min(bestReducedCost_, rot.dualCost_);
-				}
-			}
-		}
-	}
+	for(const VeryShortSucc& succ: veryShortSuccs_)
+		for(int k=0; k <= nDays_ - succ.size_; k++)
+			if(addVeryShortRotation(k, succ, costOfVeryShortRotation(k, succ)))
+				nFound ++;
 	return nFound > 0;
 }
 
-// Compute the cost of a single short rotation
-double SubProblem::costOfVeryShortRotation(int startDate, vector<int> succ){
+// Compute the cost of a single short rotation from the decomposition of its succession and the tables of the current costs
+double SubProblem::costOfVeryShortRotation(int startDate, const VeryShortSucc& succ){
+
+	int endDate = startDate + succ.size_ - 1;
+	bool endsOnLastDay = (endDate == nDays_-1);
+	const ShiftRun* runs = &veryShortRuns_[succ.firstRun_];
+
+	// A. DATE COSTS: COMPLETE WEEKENDS, WEEKEND, FIRST AND LAST DAY DUAL COSTS
+	//
+	double ANS = veryShortDateCosts_[succ.size_*(nDays_+1)+startDate];
+
+	// B. PREFERENCES AND DAY/SHIFT DUAL COSTS (by run, with the prefix sums)
+	//
+	for(int r=0; r<succ.nRuns_; r++){
+		const double* prefix = &dayShiftCostPrefix_[runs[r].shift_*(nDays_+1)];
+		int k = startDate + runs[r].offset_;
+		ANS += prefix[k+runs[r].length_] - prefix[k];
+	}
+
+	// C. CONSECUTIVE SHIFTS AND DAYS, GENERAL CASE
+	//
+	if(startDate > 0 or pLiveNurse_->pStateIni_->shift_ == 0){
+		ANS += succ.innerConsShiftsCost_ + (endsOnLastDay ? succ.lastRunExcessCost_ : succ.lastRunCost_);
+		if(!endsOnLastDay) ANS += succ.consDaysCost_;
+		// Cost of a too short rest before the first day
+		if(startDate == 0) ANS += pPenalties_->consDaysOffShortageCost(pLiveNurse_->pStateIni_->consDaysOff_);
+		return ANS;
+	}
+
+	// D. CONSECUTIVE SHIFTS AND DAYS, SPECIAL CASE OF THE FIRST DAY WHEN THE NURSE WAS WORKING
+	//
+	int shiftIni = pLiveNurse_->pStateIni_->shift_;
+	int nConsShiftIni = pLiveNurse_->pStateIni_->consShifts_;
+	int nConsWorkIni = pLiveNurse_->pStateIni_->consDaysWorked_;
+	if(pScenario_->isForbiddenSuccessor(runs[0].shift_, shiftIni))
+		return MAX_COST;
+
+	// If worked too much, subtract the already counted surplus
+	ANS -= pPenalties_->consDaysWorkExcessCost(nConsWorkIni) + pPenalties_->consShiftExcessCost(shiftIni, nConsShiftIni);
+	if(!endsOnLastDay) ANS += consDaysCost(succ.size_ + nConsWorkIni);
+
+	// The succession does not follow a rest: replace its cost by the one of the initial shifts
+	double consShiftsCost = succ.innerConsShiftsCost_ - consShiftCost(0, 0);
+	int nLast = runs[succ.nRuns_-1].length_;
+	if(runs[0].shift_ != shiftIni)
+		consShiftsCost += consShiftCost(shiftIni, nConsShiftIni);
+	// The first run continues the initial shifts
+	else if(succ.nRuns_ > 1)
+		consShiftsCost += consShiftCost(shiftIni, runs[0].length_ + nConsShiftIni) - consShiftCost(shiftIni, runs[0].length_);
+	else
+		nLast += nConsShiftIni;
+	int lastShift = runs[succ.nRuns_-1].shift_;
+	consShiftsCost += endsOnLastDay ? pPenalties_->consShiftExcessCost(lastShift, nLast) : consShiftCost(lastShift, nLast);
+
+	return ANS + consShiftsCost;
+}
+
+// Compute the cost of a single succession of any size from scratch (used by the heuristic)
+double SubProblem::costOfVeryShortRotation(int startDate, const vector<int>& succ){
 
 	int endDate = startDate + succ.size() - 1;
 	// Regular costs
@@ -1446,13 +1829,13 @@ double SubProblem::costOfVeryShortRotation(int startDate, vector<int> succ){
 			consShifts = pLiveNurse_->pStateIni_->consShifts_;
 			consDays += pLiveNurse_->pStateIni_->consDaysWorked_;
 			// If worked too much, subtract the already counted surplus
-			consDaysRegCost -= max(0, pLiveNurse_->pStateIni_->consDaysWorked_ - pContract_->maxConsDaysWork_) * WEIGHT_CONS_DAYS_WORK;
-			consShiftsRegCost -= max(0, pLiveNurse_->pStateIni_->consShifts_ - pScenario_->maxConsShifts_[shift]) * WEIGHT_CONS_SHIFTS;
+			consDaysRegCost -= pPenalties_->consDaysWorkExcessCost(pLiveNurse_->pStateIni_->consDaysWorked_);
+			consShiftsRegCost -= pPenalties_->consShiftExcessCost(shift, pLiveNurse_->pStateIni_->consShifts_);
 		}
 		// The nurse was resting
 		else {
 			// Cost of a too short rest
-			shortRestRegCost += max(0, pContract_->minConsDaysOff_ - pLiveNurse_->pStateIni_->consDaysOff_) * WEIGHT_CONS_DAYS_OFF;
+			shortRestRegCost += pPenalties_->consDaysOffShortageCost(pLiveNurse_->pStateIni_->consDaysOff_);
 		}
 	}
 
@@ -1623,7 +2006,7 @@ void SubProblem::r_c_shortest_paths_dispatch_several_sinks( const Graph& g,
   Resource_Extension_Function& ref,
   Dominance_Function& dominance,
   // to specify the memory management strategy for the labels
-  Label_Allocator /*la*/,
+  Label_Allocator la,
   Visitor vis ){
   pareto_optimal_resource_containers.clear();
   pareto_optimal_solutions.clear();
@@ -1634,7 +2017,7 @@ void SubProblem::r_c_shortest_paths_dispatch_several_sinks( const Graph& g,
       Label_Allocator::template rebind
         <boost::r_c_shortest_paths_label
           <Graph, Resource_Container> >::other LAlloc;
-  LAlloc l_alloc;
+  LAlloc l_alloc( la );		// copy of the given allocator (it may hold a memory arena)
   typedef
     ks_smart_pointer
       <boost::r_c_shortest_paths_label<Graph, Resource_Container> > Splabel;
@@ -1889,6 +2272,20 @@ void SubProblem::r_c_shortest_paths_dispatch_several_sinks( const Graph& g,
     }
   }
 
+  // if the visitor has stopped the loop, delete the dominated labels that are still in the queue
+  // (the others are deleted at the end of the function)
+  while( unprocessed_labels.size() )
+  {
+    Splabel l = unprocessed_labels.top();
+    unprocessed_labels.pop();
+    if( l->b_is_dominated )
+    {
+      l->b_is_valid = false;
+      l_alloc.destroy( l.get() );
+      l_alloc.deallocate( l.get(), 1 );
+    }
+  }
+
   // ------------------------------------------------------------------------- START SAMUEL
   typename std::list<Splabel>::const_iterator csi;
   typename std::list<Splabel>::const_iterator csi_end;
@@ -1968,6 +2365,459 @@ void SubProblem::r_c_shortest_paths_dispatch_several_sinks( const Graph& g,
 
 
 
+//----------------------------------------------------------------
+//
+// Day-bucketed labeling algorithm
+//
+//----------------------------------------------------------------
+
+// Builds the CSR topology (and its topological order) if it is not shared with another subproblem,
+// and the resource arrays from the graph
+void SubProblem::initCsrTopology(spp_csr_topology* pTopology){
+
+	if(!pTopology) pTopology = pOwnedTopology_ = new spp_csr_topology();
+	pTopology_ = pTopology;
+
+	// Current resources of the graph (one copy per subproblem)
+	networkResources_.arcCost.clear();
+	networkResources_.arcTime.clear();
+	networkResources_.nodeLat.clear();
+	for(int a=0; a<nArcs_; a++){
+		networkResources_.arcCost.push_back(arcCost(a));
+		networkResources_.arcTime.push_back(arcLength(a));
+	}
+	for(int v=0; v<nNodes_; v++) networkResources_.nodeLat.push_back(nodeLat(v));
+
+	labelsAtNode_.clear();
+	labelsAtNode_.resize(nNodes_);
+
+	// The topology is built by the first subproblem of the contract, and never modified afterwards
+	if(pTopology->nNodes > 0) return;
+
+	pTopology->nNodes = nNodes_;
+	pTopology->nArcs = nArcs_;
+	pTopology->source = sourceNode_;
+
+	// Arcs sorted by origin
+	pTopology->firstOutArc.assign(nNodes_+1, 0);
+	for(int a=0; a<nArcs_; a++) pTopology->firstOutArc[arcOrigin(a)+1]++;
+	for(int v=0; v<nNodes_; v++) pTopology->firstOutArc[v+1] += pTopology->firstOutArc[v];
+	pTopology->outArcs.assign(nArcs_, -1);
+	vector<int> nextPosition(pTopology->firstOutArc.begin(), pTopology->firstOutArc.end()-1);
+	pTopology->origin.assign(nArcs_, -1);
+	pTopology->destination.assign(nArcs_, -1);
+	for(int a=0; a<nArcs_; a++){
+		pTopology->outArcs[nextPosition[arcOrigin(a)]++] = a;
+		pTopology->origin[a] = arcOrigin(a);
+		pTopology->destination[a] = arcDestination(a);
+	}
+	pTopology->eat.clear();
+	for(int v=0; v<nNodes_; v++) pTopology->eat.push_back(nodeEat(v));
+
+	// Days of the nodes
+	pTopology->day = principalToDay_;
+	for(int k=0; k<nDays_; k++){
+		pTopology->day[rotationLengthEntrance_[k]] = k;
+		for(int v: rotationLengthNodes_[k])
+			if(v >= 0) pTopology->day[v] = k;
+		pTopology->day[sinkNodesByDay_[k]] = k;
+	}
+	pTopology->day[sinkNode_] = nDays_-1;
+
+	// The network is acyclic
+	pTopology->topologicalOrder.clear();
+	boost::topological_sort(g_, std::back_inserter(pTopology->topologicalOrder));	// Gives the reverse topological order
+	std::reverse(pTopology->topologicalOrder.begin(), pTopology->topologicalOrder.end());
+}
+
+// Backward pass over the network (reverse topological order): lower bound on the cost from each node to the given sinks,
+// where the time windows are relaxed. The forbidden arcs are not used, unless useForbiddenArcs is true
+//
+void SubProblem::computeCompletionBounds(const spp_network_resources& resources, const vector<int>& sinks,
+		vector<double>& completionBound, bool useForbiddenArcs) const{
+	completionBound.assign(pTopology_->nNodes, numeric_limits<double>::infinity());
+	for(int t : sinks) completionBound[t] = 0;
+	for(int i=pTopology_->topologicalOrder.size()-1; i>=0; i--){
+		int v = pTopology_->topologicalOrder[i];
+		for(int j=pTopology_->firstOutArc[v]; j<pTopology_->firstOutArc[v+1]; j++){
+			int a = pTopology_->outArcs[j];
+			if(!useForbiddenArcs and resources.arcTime[a] >= MAX_TIME) continue;
+			completionBound[v] = min(completionBound[v], resources.arcCost[a] + completionBound[pTopology_->destination[a]]);
+		}
+	}
+}
+
+// Lower bound on the reduced cost of all the rotations of the nurse for the costs of the last exact solve, whatever its restrictions.
+// The arc costs of the solve are used as they are (nothing is updated). The completion bounds of the solve are reused if it has
+// used all the arcs and all the sinks, otherwise they are computed again with all the arcs in a scratch array.
+// The source arcs are priced with all the short successions of size CDMin (even those that contain a forbidden day-shift)
+//
+double SubProblem::minReducedCostLowerBound(){
+	// Cheapest completion from each node, whatever the status of the arcs
+	bool allArcsUsed = !isOptionActive(SOLVE_SINGLE_SINKNODE);
+	for(int i=0; allArcsUsed and i<forbiddenArcs_.size(); i++)
+		if(isArcForbidden(forbiddenArcs_[i])) allArcsUsed = false;
+	vector<double> scratchCompletionBound;
+	if(!allArcsUsed){
+		vector<int> allSinks;
+		for(int k=CDMin_-1; k<nDays_; k++) allSinks.push_back( sinkNodesByDay_[k] );
+		computeCompletionBounds(networkResources_, allSinks, scratchCompletionBound, true);
+	}
+	const vector<double>& completionBound = allArcsUsed ? completionBound_ : scratchCompletionBound;
+
+	// Long rotations: short succession of size CDMin, then cheapest completion from the node where it ends. On the first day,
+	// a succession may continue the shifts of the initial state (it then ends on any level of its last shift)
+	double bound = 0;
+	int shiftIni = pLiveNurse_->pStateIni_->shift_;
+	for(int s=1; s<pScenario_->nbShifts_; s++)
+		for(int k=CDMin_-1; k<nDays_; k++)
+			for(int n=1; n<=maxvalConsByShift_[s]; n++){
+				double completion = completionBound[ principalNetworkNodes_[s][k][n] ];
+				if(k == CDMin_-1 and s == shiftIni)
+					for(int m=n; m<=maxvalConsByShift_[s]; m++)
+						completion = min(completion, completionBound[ principalNetworkNodes_[s][k][m] ]);
+				if(completion == numeric_limits<double>::infinity()) continue;
+				for(int succId : allShortSuccCDMinByLastShiftCons_[s][n]){
+					int firstDay = k-CDMin_+1;
+					if(firstDay == 0 and pScenario_->isForbiddenSuccessor(allowedShortSuccBySize_[CDMin_][succId][0], shiftIni)) continue;
+					bound = min(bound, costArcShortSucc(CDMin_, succId, firstDay) + completion);
+				}
+			}
+
+	// Very short rotations (whatever the forbidden day-shifts): their costs are computed by the solve, unless it has ignored them
+	if(isOptionActive(SOLVE_SHORT_NONE)) initVeryShortCosts();
+	for(const VeryShortSucc& succ: veryShortSuccs_)
+		for(int k=0; k <= nDays_ - succ.size_; k++)
+			bound = min(bound, costOfVeryShortRotation(k, succ));
+
+	return bound;
+}
+
+// Arcs that cannot belong to a long rotation of reduced cost lower than maxReducedCost: the cheapest path through an arc
+// costs at least the forward bound of its origin + its cost + the completion bound of its destination
+// (the completion bounds are those of the last exact solve)
+//
+vector<int> SubProblem::arcsToEliminate(double maxReducedCost){
+	vector<double> forwardBound(pTopology_->nNodes, numeric_limits<double>::infinity());
+	forwardBound[pTopology_->source] = 0;
+	for(int v : pTopology_->topologicalOrder){
+		if(forwardBound[v] == numeric_limits<double>::infinity()) continue;
+		for(int i=pTopology_->firstOutArc[v]; i<pTopology_->firstOutArc[v+1]; i++){
+			int a = pTopology_->outArcs[i];
+			if(networkResources_.arcTime[a] >= MAX_TIME) continue;
+			int destin = pTopology_->destination[a];
+			forwardBound[destin] = min(forwardBound[destin], forwardBound[v] + networkResources_.arcCost[a]);
+		}
+	}
+
+	vector<int> arcs;
+	for(int v : pTopology_->topologicalOrder){
+		if(forwardBound[v] == numeric_limits<double>::infinity()) continue;
+		for(int i=pTopology_->firstOutArc[v]; i<pTopology_->firstOutArc[v+1]; i++){
+			int a = pTopology_->outArcs[i];
+			if(networkResources_.arcTime[a] >= MAX_TIME) continue;
+			double bestCost = forwardBound[v] + networkResources_.arcCost[a] + completionBound_[pTopology_->destination[a]];
+			if(bestCost < numeric_limits<double>::infinity() and bestCost > maxReducedCost + EPSILON)
+				arcs.push_back(a);
+		}
+	}
+	return arcs;
+}
+
+// Returns true if one of the n labels (cost, time) dominates the label (c,t), i.e. cost[i] <= c and time[i] <= t
+// (same rule as dominance_spptw). The labels are tested four by four with SSE2 instructions (always available on x86-64),
+// or with AVX2 for the costs when compiled with make USE_AVX2=TRUE.
+static bool isDominatedByOneOf(const double* cost, const int* time, int n, double c, int t){
+	int i=0;
+#if defined(__AVX2__) || defined(__SSE2__)
+	__m128i t4 = _mm_set1_epi32(t);
+#if defined(__AVX2__)
+	__m256d c4 = _mm256_set1_pd(c);
+#else
+	__m128d c2 = _mm_set1_pd(c);
+#endif
+	for(; i+4<=n; i+=4){
+		// bit j is set if time[i+j] > t
+		int timeGreater = _mm_movemask_ps( _mm_castsi128_ps( _mm_cmpgt_epi32( _mm_loadu_si128( (const __m128i*) (time+i) ), t4 ) ) );
+		// bit j is set if cost[i+j] <= c
+#if defined(__AVX2__)
+		int costLower = _mm256_movemask_pd( _mm256_cmp_pd( _mm256_loadu_pd(cost+i), c4, _CMP_LE_OQ ) );
+#else
+		int costLower = _mm_movemask_pd( _mm_cmple_pd( _mm_loadu_pd(cost+i), c2 ) )
+				| ( _mm_movemask_pd( _mm_cmple_pd( _mm_loadu_pd(cost+i+2), c2 ) ) << 2 );
+#endif
+		if(costLower & ~timeGreater) return true;
+	}
+#endif
+	// Scalar version (remaining labels)
+	for(; i<n; i++)
+		if(cost[i] <= c and time[i] <= t) return true;
+	return false;
+}
+
+// Inserts the label in the bucket if no label of the bucket dominates it,
+// and removes from the bucket all labels that it dominates. Returns true if the label has been inserted
+static bool addLabelToBucket(spp_label_bucket& bucket, const spp_bucket_label& label){
+	if(isDominatedByOneOf(bucket.cost.data(), bucket.time.data(), bucket.size(), label.cost, label.time))
+		return false;
+	// The bucket has not been extended yet: the dominated labels may be removed without any other update
+	int nKept = 0, n = bucket.size();
+	for(int i=0; i<n; i++)
+		if(label.cost > bucket.cost[i] or label.time > bucket.time[i])
+			bucket.move(nKept++, i);
+	bucket.resize(nKept);
+	bucket.push_back(label);
+	return true;
+}
+
+// Same for a backward label: a label dominates another one to the same sink if it is not more expensive, not longer,
+// and if it can be reached at least as late
+static bool addLabelToBucket(spp_backward_bucket& bucket, const spp_backward_label& label){
+	int n = bucket.size();
+	for(int i=0; i<n; i++)
+		if(bucket.sink[i] == label.sink and bucket.cost[i] <= label.cost and bucket.duration[i] <= label.duration
+				and bucket.latest[i] >= label.latest)
+			return false;
+	int nKept = 0;
+	for(int i=0; i<n; i++)
+		if(bucket.sink[i] != label.sink or label.cost > bucket.cost[i] or label.duration > bucket.duration[i]
+				or label.latest < bucket.latest[i])
+			bucket.move(nKept++, i);
+	bucket.resize(nKept);
+	bucket.push_back(label);
+	return true;
+}
+
+// Removes the most expensive label of the bucket (forward or backward) while it has more than labelBudget labels.
+// The bucket has not been extended yet: no label refers to its labels
+template<typename Bucket>
+static void keepCheapestLabels(Bucket& bucket, int labelBudget){
+	while(bucket.size() > labelBudget){
+		int worst = max_element(bucket.cost.begin(), bucket.cost.end()) - bucket.cost.begin();
+		bucket.move(worst, bucket.size()-1);
+		bucket.resize(bucket.size()-1);
+	}
+}
+
+// Solves the SPPRC from the source to all given sinks.
+// Since the nodes are treated in topological order, all labels of a node are known (and final) when it is extended:
+// there is no need for a priority queue and a label is never extended before being dominated.
+void SubProblem::r_c_shortest_paths_day_buckets(const spp_network_resources& resources, const vector<double>& completionBound, double maxCost,
+		int maxTime, int labelBudget, vector<spp_label_bucket>& labelsAtNode, const vector<int>& sinks,
+		vector< vector< boost::graph_traits<Graph>::edge_descriptor > >& pareto_optimal_solutions,
+		vector<spp_spptw_res_cont>& pareto_optimal_resource_containers, long& nbLabels) const{
+
+	pareto_optimal_solutions.clear();
+	pareto_optimal_resource_containers.clear();
+
+	// Empty the buckets (their capacity is kept)
+	labelsAtNode.resize(pTopology_->nNodes);
+	for(spp_label_bucket& bucket : labelsAtNode) bucket.clear();
+	labelsAtNode[pTopology_->source].push_back( spp_bucket_label(0, 0) );
+
+	// 1. Extend all labels, node by node, in topological order
+	//
+	for(int v : pTopology_->topologicalOrder){
+		const spp_label_bucket& bucket = labelsAtNode[v];
+		if(bucket.empty()) continue;
+		for(int i=pTopology_->firstOutArc[v]; i<pTopology_->firstOutArc[v+1]; i++){
+			int a = pTopology_->outArcs[i];
+			int destin = pTopology_->destination[a];
+			double arcCost = resources.arcCost[a];
+			int arcTime = resources.arcTime[a], eat = pTopology_->eat[destin], lat = min(resources.nodeLat[destin], maxTime);
+			// Same extension as ref_spptw (with the completion bounds)
+			double maxLabelCost = maxCost + EPSILON - completionBound[destin];
+			for(int l=0; l<bucket.size(); l++){
+				double cost = bucket.cost[l] + arcCost;
+				if(cost >= maxLabelCost) continue;
+				int time = max(bucket.time[l] + arcTime, eat);
+				if(time > lat) continue;
+				nbLabels++;
+				if(addLabelToBucket(labelsAtNode[destin], spp_bucket_label(cost, time, a, v, l)) and labelBudget > 0)
+					keepCheapestLabels(labelsAtNode[destin], labelBudget);
+			}
+		}
+	}
+
+	// 2. Build the Pareto-optimal paths of each sink (arcs stored from the last one to the first one, as in boost)
+	//
+	for(int t : sinks){
+		const spp_label_bucket& sinkBucket = labelsAtNode[t];
+		for(int l=0; l<sinkBucket.size(); l++){
+			vector< boost::graph_traits<Graph>::edge_descriptor > path;
+			int v = t, i = l;
+			while(labelsAtNode[v].arc[i] >= 0){
+				const spp_label_bucket& bucket = labelsAtNode[v];
+				path.push_back( arcsDescriptors_[bucket.arc[i]] );
+				v = bucket.predNode[i];
+				i = bucket.predLabel[i];
+			}
+			pareto_optimal_solutions.push_back(path);
+			pareto_optimal_resource_containers.push_back( spp_spptw_res_cont(sinkBucket.cost[l], sinkBucket.time[l]) );
+		}
+	}
+}
+
+// Bidirectional version of the day-bucketed labeling algorithm.
+// Each path to a sink of day >= midDay uses exactly one arc (u,v) with day(u) < midDay <= day(v) (the days never decrease
+// along the arcs): the forward labels of u and the backward labels of v are joined on these arcs. The earliest arrival times
+// of the nodes of the rotation network are all 0, so the time is additive: a backward label stores the duration of its path
+// to the sink and the latest time at which its node can be reached, and the joined labels have the same resources as the
+// forward labels at the sinks. The Pareto-fronts at the sinks are thus the same as with the day-bucketed algorithm.
+void SubProblem::r_c_shortest_paths_bidirectional(const spp_network_resources& resources, const vector<double>& completionBound, double maxCost,
+		int maxTime, int labelBudget, vector<spp_label_bucket>& forwardLabelsAtNode, vector<spp_backward_bucket>& backwardLabelsAtNode, const vector<int>& sinks, int midDay,
+		vector< vector< boost::graph_traits<Graph>::edge_descriptor > >& pareto_optimal_solutions,
+		vector<spp_spptw_res_cont>& pareto_optimal_resource_containers, long& nbLabels) const{
+
+	pareto_optimal_solutions.clear();
+	pareto_optimal_resource_containers.clear();
+
+	const vector<int>& day = pTopology_->day;
+	const vector<int>& order = pTopology_->topologicalOrder;
+	double infinity = numeric_limits<double>::infinity();
+
+	// Empty the buckets (their capacity is kept)
+	forwardLabelsAtNode.resize(pTopology_->nNodes);
+	backwardLabelsAtNode.resize(pTopology_->nNodes);
+	for(spp_label_bucket& bucket : forwardLabelsAtNode) bucket.clear();
+	for(spp_backward_bucket& bucket : backwardLabelsAtNode) bucket.clear();
+	forwardLabelsAtNode[pTopology_->source].push_back( spp_bucket_label(0, 0) );
+
+	// 1. Forward labeling on the days before midDay (same extension as in the day-bucketed algorithm)
+	//
+	for(int v : order){
+		if(day[v] >= midDay) continue;
+		const spp_label_bucket& bucket = forwardLabelsAtNode[v];
+		if(bucket.empty()) continue;
+		for(int i=pTopology_->firstOutArc[v]; i<pTopology_->firstOutArc[v+1]; i++){
+			int a = pTopology_->outArcs[i];
+			int destin = pTopology_->destination[a];
+			if(day[destin] >= midDay) continue;
+			double arcCost = resources.arcCost[a];
+			int arcTime = resources.arcTime[a], eat = pTopology_->eat[destin], lat = min(resources.nodeLat[destin], maxTime);
+			double maxLabelCost = maxCost + EPSILON - completionBound[destin];
+			for(int l=0; l<bucket.size(); l++){
+				double cost = bucket.cost[l] + arcCost;
+				if(cost >= maxLabelCost) continue;
+				int time = max(bucket.time[l] + arcTime, eat);
+				if(time > lat) continue;
+				nbLabels++;
+				if(addLabelToBucket(forwardLabelsAtNode[destin], spp_bucket_label(cost, time, a, v, l)) and labelBudget > 0)
+					keepCheapestLabels(forwardLabelsAtNode[destin], labelBudget);
+			}
+		}
+	}
+
+	// 2. Backward labeling from all the sinks of the days from midDay at once, in reverse topological order (a node pulls the
+	// labels of its successors). The labels that cannot lead to a path of cost lower than maxCost from the source are dropped
+	//
+	vector<double> forwardBound(pTopology_->nNodes, infinity);
+	forwardBound[pTopology_->source] = 0;
+	for(int v : order){
+		if(forwardBound[v] == infinity) continue;
+		for(int i=pTopology_->firstOutArc[v]; i<pTopology_->firstOutArc[v+1]; i++){
+			int a = pTopology_->outArcs[i];
+			if(resources.arcTime[a] >= MAX_TIME) continue;
+			int w = pTopology_->destination[a];
+			forwardBound[w] = min(forwardBound[w], forwardBound[v] + resources.arcCost[a]);
+		}
+	}
+	for(int t : sinks)
+		if(day[t] >= midDay and forwardBound[t] < maxCost + EPSILON)
+			backwardLabelsAtNode[t].push_back( spp_backward_label(0, 0, min(resources.nodeLat[t], maxTime), t) );
+	for(int i=order.size()-1; i>=0; i--){
+		int v = order[i];
+		if(day[v] < midDay or forwardBound[v] == infinity) continue;
+		int eat = pTopology_->eat[v], lat = min(resources.nodeLat[v], maxTime);
+		double maxLabelCost = maxCost + EPSILON - forwardBound[v];
+		for(int j=pTopology_->firstOutArc[v]; j<pTopology_->firstOutArc[v+1]; j++){
+			int a = pTopology_->outArcs[j];
+			int w = pTopology_->destination[a];
+			const spp_backward_bucket& bucket = backwardLabelsAtNode[w];
+			double arcCost = resources.arcCost[a];
+			int arcTime = resources.arcTime[a];
+			for(int l=0; l<bucket.size(); l++){
+				double cost = bucket.cost[l] + arcCost;
+				if(cost >= maxLabelCost) continue;
+				// Reaching v at time x, the arc leads to w at x + time(a), which must be at most the latest time of the label of w
+				int latest = min(lat, bucket.latest[l] - arcTime);
+				if(latest < eat) continue;
+				nbLabels++;
+				if(addLabelToBucket(backwardLabelsAtNode[v], spp_backward_label(cost, bucket.duration[l] + arcTime, latest, bucket.sink[l], a, w, l))
+						and labelBudget > 0)
+					keepCheapestLabels(backwardLabelsAtNode[v], labelBudget);
+			}
+		}
+	}
+
+	// 3. Join on the arcs that enter midDay: the joined labels of each sink are filtered by dominance (cost, time at the sink)
+	// before any path is built. A joined label stores the arc of the join and the positions of its forward and backward labels
+	//
+	vector<int> sinkPosition(pTopology_->nNodes, -1);
+	for(int i=0; i<sinks.size(); i++) sinkPosition[sinks[i]] = i;
+	vector<spp_label_bucket> joinedLabels(sinks.size());
+	for(int u : order){
+		if(day[u] >= midDay) continue;
+		const spp_label_bucket& forwardBucket = forwardLabelsAtNode[u];
+		if(forwardBucket.empty()) continue;
+		for(int i=pTopology_->firstOutArc[u]; i<pTopology_->firstOutArc[u+1]; i++){
+			int a = pTopology_->outArcs[i];
+			int v = pTopology_->destination[a];
+			const spp_backward_bucket& backwardBucket = backwardLabelsAtNode[v];
+			if(day[v] < midDay or backwardBucket.empty()) continue;
+			for(int f=0; f<forwardBucket.size(); f++){
+				int arrival = max(forwardBucket.time[f] + resources.arcTime[a], pTopology_->eat[v]);
+				double forwardCost = forwardBucket.cost[f] + resources.arcCost[a];
+				for(int b=0; b<backwardBucket.size(); b++){
+					double cost = forwardCost + backwardBucket.cost[b];
+					if(arrival > backwardBucket.latest[b] or cost >= maxCost + EPSILON) continue;
+					addLabelToBucket(joinedLabels[sinkPosition[backwardBucket.sink[b]]],
+							spp_bucket_label(cost, arrival + backwardBucket.duration[b], a, f, b));
+				}
+			}
+		}
+	}
+
+	// 4. Build the Pareto-optimal paths of each sink (arcs stored from the last one to the first one, as in boost):
+	// the forward labels of the sinks before midDay, the joined labels of the other ones
+	//
+	for(int i=0; i<sinks.size(); i++){
+		int t = sinks[i];
+		const spp_label_bucket& sinkBucket = (day[t] < midDay) ? forwardLabelsAtNode[t] : joinedLabels[i];
+		for(int l=0; l<sinkBucket.size(); l++){
+			vector< boost::graph_traits<Graph>::edge_descriptor > path;
+			int u = t, f = l;
+			if(day[t] >= midDay){
+				// Arcs from the sink back to the destination of the join, then the arc of the join
+				int a = sinkBucket.arc[l], b = sinkBucket.predLabel[l];
+				vector<int> backwardArcs;
+				for(int w = pTopology_->destination[a]; backwardLabelsAtNode[w].arc[b] >= 0; ){
+					const spp_backward_bucket& bucket = backwardLabelsAtNode[w];
+					backwardArcs.push_back(bucket.arc[b]);
+					w = bucket.succNode[b];
+					b = bucket.succLabel[b];
+				}
+				for(int j=backwardArcs.size()-1; j>=0; j--) path.push_back( arcsDescriptors_[backwardArcs[j]] );
+				path.push_back( arcsDescriptors_[a] );
+				u = pTopology_->origin[a];
+				f = sinkBucket.predNode[l];
+			}
+			// Arcs from the origin of the join (or from the sink) back to the source
+			while(forwardLabelsAtNode[u].arc[f] >= 0){
+				const spp_label_bucket& bucket = forwardLabelsAtNode[u];
+				path.push_back( arcsDescriptors_[bucket.arc[f]] );
+				u = bucket.predNode[f];
+				f = bucket.predLabel[f];
+			}
+			pareto_optimal_solutions.push_back(path);
+			pareto_optimal_resource_containers.push_back( spp_spptw_res_cont(sinkBucket.cost[l], sinkBucket.time[l]) );
+		}
+	}
+}
+
+
+
+
 //----------------------------------------------------------------
 //
 // Greedy heuristic for the shortest path problem with resource
@@ -2248,9 +3098,9 @@ string SubProblem::shortNameNode(int v){
 	}
 
 	else if (type_v == PRINCIPAL_NETWORK){
-		int k = principalToDay_.at(v);
-		int cons = principalToCons_.at(v);
-		rep << (pScenario_->intToShift_[principalToShift_.at(v)])[0] << "-" << k << "-" << cons;
+		int k = principalToDay_[v];
+		int cons = principalToCons_[v];
+		rep << (pScenario_->intToShift_[principalToShift_[v]])[0] << "-" << k << "-" << cons;
 	}
 
 	else if (type_v == ROTATION_LENGTH_ENTRANCE){
@@ -2388,8 +3238,8 @@ void SubProblem::printPath(vector< boost::graph_traits<Graph>::edge_descriptor >
 				std::cout << " |";
 				k++;
 			}
-			int succId = shortSuccCDMinIdFromArc_.at(a);
-			for(int s: allowedShortSuccBySize_[CDMin_][ shortSuccCDMinIdFromArc_.at(a) ]){
+			int succId = shortSuccCDMinIdFromArc_[a];
+			for(int s: allowedShortSuccBySize_[CDMin_][succId]){
 				std::cout << pScenario_->intToShift_[s].at(0) << "|";
 				k++;
 			}
@@ -2412,8 +3262,8 @@ void SubProblem::printRotation(Rotation rot){
 	std::cout << "# \t| ROTATION:" << "  cost=" << rot.cost_ << "  dualCost=" << rot.dualCost_ << "  firstDay=" << rot.firstDay_ << "  length=" << rot.length_ << std::endl;
 	std::cout << "# \t            |";
 	vector<int> allTasks (nDays_);
-	for(map<int,int>::iterator itTask = rot.shifts_.begin(); itTask != rot.shifts_.end(); ++itTask)
-		allTasks[itTask->first] = itTask->second;
+	for(int k=rot.firstDay_; k<rot.firstDay_+rot.length_; ++k)
+		allTasks[k] = rot.shift(k);
 	for(int i=0; i<allTasks.size(); i++){
 		if(allTasks[i] < 1) std::cout << " |";
 		else std::cout << pScenario_->intToShift_[allTasks[i]].at(0) << "|";
@@ -2498,6 +3348,87 @@ void SubProblem::printContractAndPrefenrences(){
 	std::cout << "# " << std::endl;
 }
 
+// Solves the SPPRC of the nurse with the day-bucketed and the bidirectional algorithms (for the given costs, then for nTests random
+// costs, forbidden day-shifts and maximum rotation lengths), and returns true if they find the same Pareto-fronts at all the sinks.
+// The paths found by the bidirectional algorithm are also checked against their resources
+//
+bool SubProblem::testSpprcBidirectional(LiveNurse* nurse, DualCosts* costs, int nTests){
+
+	pLiveNurse_ = nurse;
+	vector<int> allSinks;
+	for(int k=CDMin_-1; k<nDays_; k++) allSinks.push_back( sinkNodesByDay_[k] );
+
+	bool equivalent = true;
+	for(int test=0; test<=nTests; test++){
+
+		// The given costs first, then random ones
+		setSolveOptions(test ? solveOptionBit(SOLVE_COST_RANDOM) : 0);
+		pCosts_ = costs;
+		initStructuresForSolve();
+		if(test) generateRandomCosts(-50,50);
+		forbid(DayShiftSet(nDays_, pScenario_->nbShifts_, test ? randomForbiddenShifts(25) : EMPTY_FORBIDDEN_LIST), false);
+		updateArcCosts();
+		int maxTime = test ? pContract_->maxConsDaysWork_ + rdm_() % (nDays_+1) : nDays_+maxOngoingDaysWorked_;
+		computeCompletionBounds(networkResources_, allSinks, completionBound_);
+
+		vector< vector< boost::graph_traits<Graph>::edge_descriptor > > paths[2];
+		vector<spp_spptw_res_cont> resources[2];
+		long nbLabels = 0;
+		r_c_shortest_paths_day_buckets(networkResources_, completionBound_, 0, maxTime, 0, labelsAtNode_, allSinks,
+				paths[0], resources[0], nbLabels);
+		r_c_shortest_paths_bidirectional(networkResources_, completionBound_, 0, maxTime, 0, labelsAtNode_, backwardLabelsAtNode_,
+				allSinks, nDays_/2, paths[1], resources[1], nbLabels);
+
+		// Pareto-front (time, cost) of each sink, sorted by time. The costs are sums of the same arc costs in different orders:
+		// the paths whose costs only differ by rounding errors are counted once
+		map<int, vector<pair<int,double> > > fronts[2];
+		for(int i=0; i<2; i++){
+			map<int, vector<pair<int,double> > > paretoPaths;
+			for(int p=0; p<paths[i].size(); p++)
+				paretoPaths[ boost::target(paths[i][p][0], g_) ].push_back( pair<int,double>(resources[i][p].time, resources[i][p].cost) );
+			for(map<int, vector<pair<int,double> > >::iterator it = paretoPaths.begin(); it != paretoPaths.end(); ++it){
+				sort(it->second.begin(), it->second.end());
+				double minCost = numeric_limits<double>::infinity();
+				for(const pair<int,double>& path : it->second)
+					if(path.second < minCost - EPSILON){
+						fronts[i][it->first].push_back(path);
+						minCost = path.second;
+					}
+			}
+		}
+		for(int t : allSinks){
+			vector<pair<int,double> >& front = fronts[0][t], & bidirectionalFront = fronts[1][t];
+			bool sameFront = front.size() == bidirectionalFront.size();
+			for(int l=0; sameFront and l<front.size(); l++)
+				sameFront = front[l].first == bidirectionalFront[l].first and fabs(front[l].second - bidirectionalFront[l].second) < EPSILON;
+			if(!sameFront){
+				equivalent = false;
+				std::cout << "# BIDIRECTIONAL SPPRC (test " << test << "): " << bidirectionalFront.size() << " paths instead of "
+						<< front.size() << " at the sink of node " << t << std::endl;
+			}
+		}
+
+		// Cost and time of the paths of the bidirectional algorithm
+		for(int p=0; p<paths[1].size(); p++){
+			double cost = 0;
+			int time = 0;
+			for(int j=paths[1][p].size()-1; j>=0; j--){
+				int a = boost::get(&Arc_Properties::num, g_, paths[1][p][j]);
+				cost += networkResources_.arcCost[a];
+				time += networkResources_.arcTime[a];
+			}
+			if(fabs(cost - resources[1][p].cost) > EPSILON or time != resources[1][p].time){
+				equivalent = false;
+				std::cout << "# BIDIRECTIONAL SPPRC (test " << test << "): path of cost " << cost << " and time " << time
+						<< " instead of " << resources[1][p].cost << " and " << resources[1][p].time << std::endl;
+			}
+		}
+
+		if(test) delete pCosts_;
+	}
+	return equivalent;
+}
+
 
 
 
@@ -16,11 +16,15 @@
 #include <boost/config.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/r_c_shortest_paths.hpp>
+#include <boost/graph/topological_sort.hpp>
 
 
 static int MAX_COST = 99999;
 static int MAX_TIME = 99999;
 
+// Below this change, a dual cost is considered unchanged from one solve to the next one (the arc costs are not updated)
+static const double DUAL_COST_TOLERANCE = 1e-8;
+
 // Different node types and their names
 //
 enum NodeType {
@@ -46,6 +50,26 @@ static const vector<string> arcTypeName = {
 
 static const set<pair<int,int> > EMPTY_FORBIDDEN_LIST;
 
+// Set of (day, shift) couples stored as a bitset: the bit k*nbShifts+s is set if the couple (k,s) is in the set.
+// Two sets of the same dimensions are compared 64 couples at a time.
+//
+struct DayShiftSet{
+	DayShiftSet(int nbDays = 0, int nbShifts = 0): nbShifts_(nbShifts), words_((nbDays*nbShifts+63)/64, 0) {}
+	DayShiftSet(int nbDays, int nbShifts, const set<pair<int,int> >& dayShifts): DayShiftSet(nbDays, nbShifts){
+		for(const pair<int,int>& p: dayShifts) insert(p.first, p.second);
+	}
+
+	int nbShifts_;
+	vector<uint64_t> words_;
+
+	inline void insert(int k, int s){int b = k*nbShifts_+s; words_[b/64] |= (uint64_t) 1 << (b%64);}
+	inline void erase(int k, int s){int b = k*nbShifts_+s; words_[b/64] &= ~((uint64_t) 1 << (b%64));}
+	inline bool contains(int k, int s) const {int b = k*nbShifts_+s; return (words_[b/64] >> (b%64)) & 1;}
+	inline void clear(){fill(words_.begin(), words_.end(), 0);}
+	inline bool empty() const {for(uint64_t w: words_) if(w) return false; return true;}
+	inline bool operator==(const DayShiftSet& other) const {return words_ == other.words_;}
+};
+
 // Different solution options. The first one is the default one if no other from the subset is specified.
 enum SolveOption{
 
@@ -76,15 +100,33 @@ enum SolveOption{
 	// Costs options (mainly for debug purpose
 	//
 	SOLVE_COST_GIVEN,				// DEFAULT: Solve the problem for the given reduced costs
-	SOLVE_COST_RANDOM				//          Generate random cost instead
+	SOLVE_COST_RANDOM,				//          Generate random cost instead
+
+	// Labeling algorithm used for the long rotations
+	//
+	SOLVE_SPPRC_BOOST,				// DEFAULT: Generic labeling algorithm (modified from boost, priority queue of labels)
+	SOLVE_SPPRC_DAY_BUCKETS,		//          Labeling in topological (day) order of the network, one bucket of labels per node
+	SOLVE_SPPRC_BIDIRECTIONAL,		//          Day-bucketed labeling forward from the source and backward from the sinks up to the middle day, then join
+
+	// Paths returned by the (boost) labeling algorithm
+	//
+	SOLVE_LABELS_PARETO_FRONT,		// DEFAULT: Complete Pareto-front of each sink
+	SOLVE_LABELS_KBEST,				//          Stop as soon as K labels of reduced cost lower than the bound have reached a sink
+	SOLVE_LABELS_BUDGET				//          Keep at most L labels (those of lowest cost) at each node (day-bucketed algorithms only)
 };
 
+// Set of solve options stored as a bitmask (there are less than 64 options)
+typedef uint64_t SolveOptionMask;
+inline SolveOptionMask solveOptionBit(SolveOption option){return (SolveOptionMask) 1 << option;}
+
 static const vector<vector<SolveOption> > incompatibilityClusters = {
 		{SOLVE_SOLUTIONS_RESET, SOLVE_SOLUTIONS_KEEP},
 		{SOLVE_ONE_SINK_PER_LAST_DAY, SOLVE_SINGLE_SINKNODE},
 		{SOLVE_SHORT_DAY_0_AND_LAST_ONLY, SOLVE_SHORT_DAY_0_ONLY, SOLVE_SHORT_LAST_ONLY, SOLVE_SHORT_ALL, SOLVE_SHORT_NONE},
 		{SOLVE_FORBIDDEN_RESET, SOLVE_FORBIDDEN_KEEP, SOLVE_FORBIDDEN_RANDOM},
-		{SOLVE_COST_GIVEN, SOLVE_COST_RANDOM}
+		{SOLVE_COST_GIVEN, SOLVE_COST_RANDOM},
+		{SOLVE_SPPRC_BOOST, SOLVE_SPPRC_DAY_BUCKETS, SOLVE_SPPRC_BIDIRECTIONAL},
+		{SOLVE_LABELS_PARETO_FRONT, SOLVE_LABELS_KBEST, SOLVE_LABELS_BUDGET}
 };
 
 static const vector<string> solveOptionName = {
@@ -92,7 +134,9 @@ static const vector<string> solveOptionName = {
 		"One sink node per last day", "Single sink node",
 		"Short rotations that start at 0 or end on last day only", "Short rotations that start on day 0 only", "Short rotations that end on last day only","Price all very short rotations", "Price NO very short rotation",
 		"Reset all forbidden before solve", "Keep all forbidden before solve", "Generate random forbidden day-shift",
-		"Solve for given reduced costs", "Generate random reduced costs"
+		"Solve for given reduced costs", "Generate random reduced costs",
+		"Boost labeling algorithm", "Day-bucketed labeling algorithm", "Bidirectional labeling algorithm",
+		"Complete Pareto-front", "Stop after K good labels at the sinks", "At most L labels per node"
 };
 
 
@@ -267,17 +311,31 @@ struct spp_spptw_res_cont{
 };
 
 // Resources extension model (arc has cost + travel time)
+// If completion bounds are given, the labels that cannot reach a sink with a cost lower than maxCost are not extended.
+// If maxTime is given, the labels whose time exceeds it are not extended
 class ref_spptw{
 public:
+	ref_spptw(): pCompletionBound_(0), maxCost_(0), maxTime_(MAX_TIME) {}
+	ref_spptw(const vector<double>* pCompletionBound, double maxCost, int maxTime = MAX_TIME):
+		pCompletionBound_(pCompletionBound), maxCost_(maxCost), maxTime_(maxTime) {}
+
 	inline bool operator()( const Graph& g, spp_spptw_res_cont& new_cont,	const spp_spptw_res_cont& old_cont,	boost::graph_traits<Graph>::edge_descriptor ed ) const{
 		const Arc_Properties& arc_prop = get( boost::edge_bundle, g )[ed];
 		const Vertex_Properties& vert_prop = get( boost::vertex_bundle, g )[target( ed, g )];
 		new_cont.cost = old_cont.cost + arc_prop.cost;
+		if(pCompletionBound_ and new_cont.cost + (*pCompletionBound_)[target( ed, g )] >= maxCost_ + EPSILON) return false;
 		int& i_time = new_cont.time;
 		i_time = old_cont.time + arc_prop.time;
 		i_time < vert_prop.eat ? i_time = vert_prop.eat : 0;
-		return i_time <= vert_prop.lat ? true : false;
+		return (i_time <= vert_prop.lat and i_time <= maxTime_) ? true : false;
 	}
+
+private:
+	// For each node, lower bound on the cost of the paths to the sinks (not owned)
+	const vector<double>* pCompletionBound_;
+	double maxCost_;
+	// Bound on the time of all the labels (in addition to the latest arrival times of the nodes)
+	int maxTime_;
 };
 
 // Dominance function model
@@ -302,6 +360,269 @@ public:
 	}
 };
 
+// Visitor of the labeling algorithm: counts the feasible labels, and the new labels that reach a sink with a cost lower
+// than maxCost. Stops the algorithm once there are K of the latter (never stops if K is not given)
+class spp_kbest_visitor: public boost::default_r_c_shortest_paths_visitor{
+public:
+	spp_kbest_visitor(const vector<bool>* pIsSink, double maxCost, long* pNbLabels, int k = numeric_limits<int>::max()):
+		pIsSink_(pIsSink), maxCost_(maxCost), k_(k), nLabelsAtSinks_(0), pNbLabels_(pNbLabels) {}
+
+	template<class Label, class Graph>
+	void on_label_feasible(const Label& l, const Graph& g){
+		(*pNbLabels_)++;
+		if((*pIsSink_)[l.resident_vertex] and l.cumulated_resource_consumption.cost < maxCost_) nLabelsAtSinks_++;
+	}
+	template<class Queue, class Graph>
+	bool on_enter_loop(const Queue& queue, const Graph& graph){ return nLabelsAtSinks_ < k_; }
+
+private:
+	const vector<bool>* pIsSink_;
+	double maxCost_;
+	int k_, nLabelsAtSinks_;
+	// Total number of feasible labels created (not owned)
+	long* pNbLabels_;
+};
+
+// Label of the day-bucketed labeling algorithm: resources of the partial path,
+// last arc used and position (node, index in the bucket) of the predecessor label
+//
+struct spp_bucket_label{
+
+	// Constructor
+	//
+	spp_bucket_label( double c = 0, int t = 0, int a = -1, int pn = -1, int pl = -1 ) : cost( c ), time( t ), arc( a ), predNode( pn ), predLabel( pl ) {}
+
+	// Current cost
+	//
+	double cost;
+
+	// Current time consumption
+	//
+	int time;
+
+	// Arc that was extended to create the label (-1 for the source label)
+	//
+	int arc;
+
+	// Predecessor label
+	//
+	int predNode;
+	int predLabel;
+};
+
+// Labels resident at a node of the day-bucketed labeling algorithm, stored as parallel
+// arrays (structure of arrays) so that the dominance tests read contiguous costs and times
+//
+struct spp_label_bucket{
+
+	// Resources, last arc and predecessor of each label
+	//
+	vector<double> cost;
+	vector<int> time;
+	vector<int> arc;
+	vector<int> predNode;
+	vector<int> predLabel;
+
+	inline int size() const {return cost.size();}
+	inline bool empty() const {return cost.empty();}
+
+	// Empty the bucket (the capacity is kept)
+	inline void clear(){cost.clear(); time.clear(); arc.clear(); predNode.clear(); predLabel.clear();}
+
+	inline void push_back(const spp_bucket_label& l){
+		cost.push_back(l.cost); time.push_back(l.time); arc.push_back(l.arc); predNode.push_back(l.predNode); predLabel.push_back(l.predLabel);
+	}
+
+	// Copy label j at position i
+	inline void move(int i, int j){
+		cost[i] = cost[j]; time[i] = time[j]; arc[i] = arc[j]; predNode[i] = predNode[j]; predLabel[i] = predLabel[j];
+	}
+
+	inline void resize(int n){cost.resize(n); time.resize(n); arc.resize(n); predNode.resize(n); predLabel.resize(n);}
+
+	// Memory reserved by the bucket (in bytes)
+	inline size_t memory() const {return cost.capacity() * (sizeof(double) + 4*sizeof(int));}
+};
+
+// Label of the backward labeling of the bidirectional algorithm: resources of a partial path from a node to a sink,
+// first arc used and position (node, index in the bucket) of the successor label
+//
+struct spp_backward_label{
+
+	// Constructor
+	//
+	spp_backward_label( double c = 0, int d = 0, int l = 0, int t = -1, int a = -1, int sn = -1, int sl = -1 ) :
+		cost( c ), duration( d ), latest( l ), sink( t ), arc( a ), succNode( sn ), succLabel( sl ) {}
+
+	// Cost of the path
+	//
+	double cost;
+
+	// Time consumed from the node to the sink, and latest time at which the node can be reached for the path to stay feasible
+	//
+	int duration;
+	int latest;
+
+	// Sink reached by the path (labels to different sinks never dominate each other)
+	//
+	int sink;
+
+	// Arc that was extended to create the label (-1 for the label of a sink)
+	//
+	int arc;
+
+	// Successor label
+	//
+	int succNode;
+	int succLabel;
+};
+
+// Backward labels resident at a node of the bidirectional labeling algorithm (structure of arrays)
+//
+struct spp_backward_bucket{
+
+	// Resources, first arc and successor of each label
+	//
+	vector<double> cost;
+	vector<int> duration;
+	vector<int> latest;
+	vector<int> sink;
+	vector<int> arc;
+	vector<int> succNode;
+	vector<int> succLabel;
+
+	inline int size() const {return cost.size();}
+	inline bool empty() const {return cost.empty();}
+
+	// Empty the bucket (the capacity is kept)
+	inline void clear(){cost.clear(); duration.clear(); latest.clear(); sink.clear(); arc.clear(); succNode.clear(); succLabel.clear();}
+
+	inline void push_back(const spp_backward_label& l){
+		cost.push_back(l.cost); duration.push_back(l.duration); latest.push_back(l.latest); sink.push_back(l.sink);
+		arc.push_back(l.arc); succNode.push_back(l.succNode); succLabel.push_back(l.succLabel);
+	}
+
+	// Copy label j at position i
+	inline void move(int i, int j){
+		cost[i] = cost[j]; duration[i] = duration[j]; latest[i] = latest[j]; sink[i] = sink[j];
+		arc[i] = arc[j]; succNode[i] = succNode[j]; succLabel[i] = succLabel[j];
+	}
+
+	inline void resize(int n){
+		cost.resize(n); duration.resize(n); latest.resize(n); sink.resize(n); arc.resize(n); succNode.resize(n); succLabel.resize(n);
+	}
+
+	// Memory reserved by the bucket (in bytes)
+	inline size_t memory() const {return cost.capacity() * (sizeof(double) + 6*sizeof(int));}
+};
+
+// Topology of the rotation network in compressed sparse row format. It is built once
+// with the graph and never modified afterwards, so it is shared by all the subproblems of a contract
+//
+struct spp_csr_topology{
+
+	// Constructor: empty topology
+	//
+	spp_csr_topology(): nNodes(0), nArcs(0), source(-1) {}
+
+	// Number of nodes and arcs, source node
+	//
+	int nNodes;
+	int nArcs;
+	int source;
+
+	// The arcs leaving node v are outArcs[firstOutArc[v]], ..., outArcs[firstOutArc[v+1]-1]
+	//
+	vector<int> firstOutArc;
+	vector<int> outArcs;
+
+	// For each arc, its origin and its destination
+	//
+	vector<int> origin;
+	vector<int> destination;
+
+	// For each node, its earliest arrival time
+	//
+	vector<int> eat;
+
+	// Nodes sorted in topological order
+	//
+	vector<int> topologicalOrder;
+
+	// For each node, the day it represents (-1 for the source). It never decreases along an arc
+	//
+	vector<int> day;
+};
+
+// Resources of the rotation network that depend on the nurse and on the reduced costs,
+// stored as flat arrays indexed by arc / node id (one copy per solve)
+//
+struct spp_network_resources{
+
+	// For each arc, its cost and travel time
+	//
+	vector<double> arcCost;
+	vector<int> arcTime;
+
+	// For each node, its latest arrival time
+	//
+	vector<int> nodeLat;
+};
+
+// Arcs whose cost only depends on the day-shift of their destination (SHIFT_TO_NEWSHIFT,
+// SHIFT_TO_SAMESHIFT and REPEATSHIFT arcs): their data is stored contiguously, so that their
+// costs can be updated with one vectorized pass
+//
+struct spp_day_shift_arcs{
+
+	// For each arc of the type: its id, the index k*nbShifts+s of the day-shift of its destination,
+	// its base cost and 1 if the destination day is a Saturday (0 otherwise)
+	//
+	vector<int> arc;
+	vector<int> dayShift;
+	vector<double> baseCost;
+	vector<double> saturday;
+
+	// Costs computed at the last update (only for the arcs of the day-shifts whose cost changed)
+	//
+	vector<double> cost;
+
+	// Once sorted, the arcs of the day-shift ds are at the positions firstArc[ds] to firstArc[ds+1]-1
+	//
+	vector<int> firstArc;
+
+	inline int size() const {return arc.size();}
+	inline void push_back(int a, int ds, double c, bool isSaturday){
+		arc.push_back(a); dayShift.push_back(ds); baseCost.push_back(c); saturday.push_back(isSaturday ? 1.0 : 0.0); cost.push_back(c);
+	}
+
+	// Sorts the arcs by day-shift of destination (stable), and sets firstArc
+	//
+	void sortByDayShift(int nDayShifts);
+};
+
+// Costs of the arcs of a subproblem for a given nurse, with the dual costs and forbidden day-shifts they have been computed with.
+// They are kept for each nurse priced with the subproblem, so that only the arcs whose costs depend on changed duals are
+// updated when the nurse is priced again (the subproblems are shared by all the nurses of a contract)
+//
+struct spp_nurse_costs{
+
+	// Initial state of the nurse, dual costs and forbidden day-shifts used at the last update
+	//
+	State* pStateIni;
+	vector< vector<double> > workCosts;											// Indexed by (day, shift) [shift 0 unused]
+	vector<double> startWorkCosts, endWorkCosts;
+	double workedWeekendCost;
+	vector< vector<bool> > dayShiftStatus;
+
+	// Costs of the arcs and best short successions of size CDMin computed at the last update
+	//
+	vector<double> arcCost;
+	vector3D idBestShortSuccCDMin;
+	vector<vector<vector<double> > > arcCostBestShortSuccCDMin;
+	vector<int> shortSuccCDMinIdFromArc;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 
 
@@ -352,6 +673,84 @@ private:
 
 
 
+//---------------------------------------------------------------------------
+//
+// C l a s s   L a b e l A r e n a
+//
+// Memory of the labels of the SPPRC. The labels are allocated by bumping a
+// pointer in large blocks, never freed one by one, and all released at once
+// by reset(). The blocks are kept from one solve to the other.
+//
+//---------------------------------------------------------------------------
+class LabelArena{
+
+public:
+
+	LabelArena(size_t blockSize = 1 << 20);
+	~LabelArena();
+
+	// Returns nBytes of memory aligned on align
+	void* allocate(size_t nBytes, size_t align);
+
+	// Releases all the labels in O(1) (the blocks are kept)
+	inline void reset(){currentBlock_ = 0; offset_ = 0; usedMemory_ = 0;}
+
+	// Memory used by the labels since the last reset, and memory reserved by the arena (in bytes)
+	inline size_t usedMemory() const {return usedMemory_;}
+	size_t reservedMemory() const;
+
+private:
+
+	// Blocks of memory and their size
+	vector<pair<char*,size_t> > blocks_;
+	// Default size of a new block
+	size_t blockSize_;
+	// Block currently used and first free byte in this block
+	int currentBlock_;
+	size_t offset_;
+	// Memory given since the last reset
+	size_t usedMemory_;
+
+	LabelArena(const LabelArena&);
+	LabelArena& operator=(const LabelArena&);
+};
+
+// Allocator of the labels that can be given as Label_Allocator to the SPPRC functions.
+// A default-constructed allocator (without arena) uses the usual new / delete.
+//
+template<class T>
+class LabelArenaAllocator{
+public:
+	typedef T value_type;
+	typedef T* pointer;
+	typedef const T* const_pointer;
+	typedef T& reference;
+	typedef const T& const_reference;
+	typedef size_t size_type;
+	typedef ptrdiff_t difference_type;
+	template<class U> struct rebind{ typedef LabelArenaAllocator<U> other; };
+
+	LabelArenaAllocator( LabelArena* pArena = 0 ) : pArena_( pArena ) {}
+	template<class U> LabelArenaAllocator( const LabelArenaAllocator<U>& other ) : pArena_( other.pArena_ ) {}
+
+	T* allocate( size_t n ){
+		if(pArena_) return static_cast<T*>( pArena_->allocate( n * sizeof(T), alignof(T) ) );
+		return static_cast<T*>( ::operator new( n * sizeof(T) ) );
+	}
+	// Nothing to do with an arena: the memory is released when the arena is reset
+	void deallocate( T* p, size_t ){ if(!pArena_) ::operator delete( p ); }
+
+	template<class U, class... Args> void construct( U* p, Args&&... args ){ new( (void*) p ) U( std::forward<Args>(args)... ); }
+	template<class U> void destroy( U* p ){ p->~U(); }
+
+	friend bool operator==( const LabelArenaAllocator& a1, const LabelArenaAllocator& a2 ){ return a1.pArena_ == a2.pArena_; }
+	friend bool operator!=( const LabelArenaAllocator& a1, const LabelArenaAllocator& a2 ){ return a1.pArena_ != a2.pArena_; }
+
+	LabelArena* pArena_;
+};
+
+
+
 //---------------------------------------------------------------------------
 //
 // C l a s s   S u b P r o b l e m
@@ -366,9 +765,11 @@ public:
 	SubProblem();
 	~SubProblem();
 
-	// Constructor that correctly sets the resource (time + bounds), but NOT THE COST
+	// Constructor that correctly sets the resource (time + bounds), but NOT THE COST.
+	// The topology of the network can be shared by the subproblems of a contract (it is not owned by them): if it is empty,
+	// it is built by this subproblem. If none is given, the subproblem builds and owns its own topology
 	//
-	SubProblem(Scenario* scenario, int nbDays, const Contract* contract, vector<State>* pInitState);
+	SubProblem(Scenario* scenario, int nbDays, const Contract* contract, vector<State>* pInitState, spp_csr_topology* pTopology = 0);
 
 	// Initialization function for all global variables (not those of the graph)
 	//
@@ -378,15 +779,52 @@ public:
 	//
 	void testGraph_spprc();
 
+	// Test function for the bidirectional labeling algorithm: solves the SPPRC of the nurse with the day-bucketed and the bidirectional
+	// algorithms, for the given costs and then for nTests random costs and forbidden day-shifts, and returns true if they always
+	// find the same Pareto-fronts at all the sinks
+	//
+	bool testSpprcBidirectional(LiveNurse* nurse, DualCosts* costs, int nTests);
+
 	// Solve : Returns TRUE if negative reduced costs path were found; FALSE otherwise.
 	//
 	bool solve(LiveNurse* nurse, DualCosts * costs, vector<SolveOption> options, set<pair<int,int> > forbiddenDayShifts = EMPTY_FORBIDDEN_LIST,
 			bool optimality = false, int maxRotationLength=MAX_TIME, double redCostBound = 0);
 
+	// Same as above with a bitmask of options and a bitset of forbidden day-shifts: only the day-shifts whose status
+	// changed since the previous solve are forbidden or authorized again
+	//
+	bool solve(LiveNurse* nurse, DualCosts * costs, SolveOptionMask options, const DayShiftSet& forbiddenDayShifts,
+			bool optimality = false, int maxRotationLength=MAX_TIME, double redCostBound = 0);
+
 	// Returns all rotations saved during the process of solving the SPPRC
 	//
 	inline vector< Rotation > getRotations(){return theRotations_;}
 
+	// Number of good labels after which the labeling algorithm stops with option SOLVE_LABELS_KBEST
+	//
+	inline void setNbKBestLabels(int k){nKBestLabels_ = k;}
+
+	// Maximum number of labels per node with option SOLVE_LABELS_BUDGET (0: no maximum, same default as SolverParam::spprcLabelBudget_).
+	// The pricer only uses it in its restricted stage: the exact stage keeps all the labels
+	//
+	inline void setLabelBudget(int l){labelBudget_ = l;}
+
+	// Arcs forbidden at each solve, in addition to the forbidden day-shifts (e.g. those eliminated by reduced cost
+	// in the current node of the branching tree)
+	//
+	inline void setEliminatedArcs(const vector<int>& arcs){eliminatedArcs_ = arcs;}
+
+	// Returns the arcs that cannot belong to a long rotation of reduced cost lower than maxReducedCost, with the costs
+	// and the authorizations of the last exact solve (forward and backward lower bounds, time relaxed)
+	//
+	vector<int> arcsToEliminate(double maxReducedCost);
+
+	// Lower bound on the reduced cost of all the rotations of the nurse for the costs of the last exact solve (not larger than 0),
+	// whatever its forbidden day-shifts, eliminated arcs and maximum rotation length: cheapest very short rotation, and cheapest
+	// path from the source with all the arcs authorized and the time windows relaxed. Must be called right after the solve
+	//
+	double minReducedCostLowerBound();
+
 	// Returns true if the corresponding shift has no maximum limit of consecutive worked days
 	//
 	inline bool isUnlimited(int sh){return isUnlimited_[sh];}
@@ -418,6 +856,10 @@ protected:
 	//
 	const Contract * pContract_;
 
+	// Penalties of the consecutive sequences of the contract (shared with the master problem)
+	//
+	const PenaltyTable * pPenalties_;
+
 	// (Minimum) number of paths to return to the MP
 	//
 	int nPathsMin_;
@@ -430,7 +872,12 @@ protected:
 	//
 	DualCosts * pCosts_;
 
-	// Maximum length of a rotation (in consecutive worked days)
+	// Random costs (for tests), viewed by pCosts_ when SOLVE_COST_RANDOM is active
+	//
+	vector<double> randomWorkCosts_, randomStartWorkCosts_, randomEndWorkCosts_;
+
+	// Maximum length of a rotation (in consecutive worked days) for the current solve. The network is built once for the
+	// rotations of at most nDays_ days: a smaller maximum only bounds the time resource in the labeling algorithms
 	//
 	int maxRotationLength_;
 
@@ -474,6 +921,10 @@ protected:
 	//
 	double bestReducedCost_;
 
+	// Memory used by the labels of the last SPPRC solved (in bytes)
+	//
+	size_t peakLabelMemory_;
+
 
 
 	//----------------------------------------------------------------
@@ -484,8 +935,9 @@ protected:
 
 	// Vector that, for each option, contains true if active, false if inactive
 	vector<bool> activeOptions_;
-	// Set the options from a vector<SolveOption>
-	void setSolveOptions(vector<SolveOption> options);
+	// Set the options from a vector<SolveOption> or from a bitmask
+	void setSolveOptions(const vector<SolveOption>& options);
+	void setSolveOptions(SolveOptionMask options);
 	// Return true if the option should be applied
 	inline bool isOptionActive(SolveOption option){return activeOptions_[option];};
 
@@ -519,9 +971,9 @@ protected:
 	vector<vector <double> > preferencesCosts_;
 
 	// Cost function for consecutive identical shifts
-	double consShiftCost(int sh, int n);
+	inline double consShiftCost(int sh, int n){ return pPenalties_->consShiftCost(sh, n); }
 	// Cost function for consecutive days
-	double consDaysCost(int n);
+	inline double consDaysCost(int n){ return pPenalties_->consDaysWorkCost(n); }
 	// Initializes the startWeekendCost vector
 	void initStartWeekendCosts();
 
@@ -562,13 +1014,13 @@ protected:
 	// Nodes of the PRINCIPAL_NETWORK subnetwork
 	vector3D principalNetworkNodes_;					// For each SHIFT, DAY, and # of CONSECUTIVE, the corresponding node id
 	vector<int> maxvalConsByShift_;						// For each shift, number of levels that the subnetwork contains
-	map<int,int> principalToShift_;						// For each node of the principal network, maps it ID to the shift it represents
-	map<int,int> principalToDay_;						// For each node of the principal network, maps it ID to the day it represents
-	map<int,int> principalToCons_;						// For each node of the principal network, maps it ID to the number of consecutive shifts it represents
+	vector<int> principalToShift_;						// For each node, the shift it represents (-1 if not in the principal network)
+	vector<int> principalToDay_;						// For each node, the day it represents (-1 if not in the principal network)
+	vector<int> principalToCons_;						// For each node, the number of consecutive shifts it represents (-1 if not in the principal network)
 	// Nodes of the ROTATION_LENGTH subnetwork
 	vector<int> rotationLengthEntrance_;				// For each day, entrance node to the ROTATION_LENGTH subnetwork
-	vector<map<int,int> > rotationLengthNodes_;			// For each day, maps the length of the rotation to the corresponding check node
-	map<int,int> rotationLengthNodesLAT_;				// For each rotation length node, the corresponding EAT
+	vector2D rotationLengthNodes_;						// Index: (day,length) of the rotation -> corresponding check node (-1 if none)
+	vector<int> rotationLengthNodesLAT_;				// For each node, the LAT if it is a rotation length node (-1 otherwise)
 	vector<int> sinkNodesByDay_;						// For each day, an intermediary sink node (to get the Pareto-front for each day)
 	// Sink Node
 	int sinkNode_;
@@ -608,8 +1060,8 @@ protected:
 	vector3D arcsShiftToEndsequence_;					// Index: (shift, day, nCons) of origin
 	vector2D arcsRepeatShift_;							// Index: (shift, day) of origin
 	vector2D arcsPrincipalToRotsizein_;					// Index: (shift, day) of origin
-	vector<map<int,int> > arcsRotsizeinToRotsizeDay_;	// Index: (day,size) of the rotation [destination]
-	vector<map<int,int> > arcsRotsizeToRotsizeoutDay_;	// Index: (day,size) of the rotation [origin]
+	vector2D arcsRotsizeinToRotsizeDay_;				// Index: (day,size) of the rotation [destination] (-1 if none)
+	vector2D arcsRotsizeToRotsizeoutDay_;				// Index: (day,size) of the rotation [origin] (-1 if none)
 	vector<int> arcsSinkDayToSink_;						// Index: (day) of the end of rotation
 
 	// ARCS -> FUNCTIONS
@@ -648,10 +1100,36 @@ protected:
 	// Cost computation of the "very" short rotations (< CD_min)
 	//
 	//----------------------------------------------------------------
+	// A run of identical shifts in a very short succession, starting offset_ days after its first day
+	struct ShiftRun{
+		int shift_, offset_, length_;
+	};
+	// A very short succession decomposed in runs of identical shifts, with the costs that do not depend on its dates
+	struct VeryShortSucc{
+		int size_, id_;																		// Size and ID in allowedShortSuccBySize_[size_]
+		int firstRun_, nRuns_;																// Its runs in veryShortRuns_
+		double innerConsShiftsCost_;														// Consecutive shifts cost of the rest before it and of all its runs but the last one
+		double lastRunCost_, lastRunExcessCost_;											// Consecutive shifts cost of the last run (only the excess if it ends on the last day)
+		double consDaysCost_;																// Consecutive days cost (only if it does not end on the last day)
+	};
+	vector<VeryShortSucc> veryShortSuccs_;													// All the allowed successions of size c \in [1,CDMin-1]
+	vector<ShiftRun> veryShortRuns_;														// Runs of all these successions
+	vector<double> dayShiftCostPrefix_;														// For each shift s and day k, sum of the preference minus dual costs of s on the days before k (index s*(nDays_+1)+k)
+	vector<double> veryShortDateCosts_;														// For each size c and first day k, weekend, start and end costs of the rotation (index c*(nDays_+1)+k)
+
+	// Decomposes the very short successions. Should only be called ONCE (after initShortSuccessions).
+	void initVeryShortSuccessions();
+	// Fills the prefix sums and the date costs of the very short rotations for the current costs
+	void initVeryShortCosts();
+
 	bool priceVeryShortRotationsFirstDay();
 	bool priceVeryShortRotationsLastDay();
 	bool priceVeryShortRotations();
-	double costOfVeryShortRotation(int firstDay, vector<int> succ);
+	// Cost of a very short rotation (MAX_COST if it cannot start on that day), and record it if it is good enough
+	double costOfVeryShortRotation(int firstDay, const VeryShortSucc& succ);
+	// Cost of a succession of any size from scratch (used by the heuristic)
+	double costOfVeryShortRotation(int firstDay, const vector<int>& succ);
+	bool addVeryShortRotation(int firstDay, const VeryShortSucc& succ, double redCost);
 
 
 
@@ -672,6 +1150,14 @@ protected:
 
 	// Function called when optimal=true in the arguments of solve
 	bool solveLongRotationsOptimal();
+	// Memory of the labels of the SPPRC (kept between two solves)
+	LabelArena labelArena_;
+	// Number of labels to reach the sinks with option SOLVE_LABELS_KBEST
+	int nKBestLabels_;
+	// Maximum number of labels per node with option SOLVE_LABELS_BUDGET (0: no maximum)
+	int labelBudget_;
+	// Number of feasible labels created during the last solve
+	long nbLabels_;
 	bool solveLongRotationsHeuristic();
 
 	// Initializes some cost vectors that depend on the nurse
@@ -681,14 +1167,14 @@ protected:
 	// Transforms the solutions found into proper rotations. Returns true if at least one has been added
 	bool addRotationsFromPaths(vector< vector< boost::graph_traits<Graph>::edge_descriptor > > paths, vector<spp_spptw_res_cont> resources);
 	// Returns the rotation made from the given path
-	Rotation rotationFromPath(vector< boost::graph_traits<Graph>::edge_descriptor > path, spp_spptw_res_cont resource);
+	Rotation rotationFromPath(const vector< boost::graph_traits<Graph>::edge_descriptor >& path, const spp_spptw_res_cont& resource);
 	// Adds a single rotation to the list of solutions
 	void addSingleRotationToListOfSolution();
 
 	// DATA -- COSTS
 	//
 	// Data structures that associates an arc to the chosen short succession of lowest cost
-	map<int,int> shortSuccCDMinIdFromArc_;						// Maps the arcs to the corresponding short rotation ID
+	vector<int> shortSuccCDMinIdFromArc_;						// For each arc, the corresponding short rotation ID (-1 if not from the source)
 	vector3D idBestShortSuccCDMin_;								// For each day k (<= nDays_ - CDMin), shift s, number n, contains the best short succession of size CDMin that starts on day k, and ends with n consecutive days of shift s
 	vector<vector<vector<double> > > arcCostBestShortSuccCDMin_;// For each day k (<= nDays_ - CDMin), shift s, number n, contains the cost of the corresponding arc
 
@@ -699,24 +1185,68 @@ protected:
 	// Given a short succession and a start date, returns the cost of the corresponding arc
 	double costArcShortSucc(int size, int id, int startDate);
 	// Single cost/time change
-	inline void updateCost(int a, double cost){boost::put( &Arc_Properties::cost, g_, arcsDescriptors_[a], cost );}
-	// Updates the costs depending on the reduced costs given for the nurse
+	inline void updateCost(int a, double cost){boost::put( &Arc_Properties::cost, g_, arcsDescriptors_[a], cost ); networkResources_.arcCost[a] = cost;}
+	// Updates the costs depending on the reduced costs given for the nurse (only those that changed since the last update)
 	void updateArcCosts();
 	// For tests, must be able to randomly generate costs
 	void generateRandomCosts(double minVal, double maxVal);
 
+	// DATA -- VECTORIZED UPDATE OF THE COSTS
+	//
+	// Arcs of types SHIFT_TO_NEWSHIFT, SHIFT_TO_SAMESHIFT and REPEATSHIFT
+	spp_day_shift_arcs newShiftArcs_, sameShiftArcs_, repeatShiftArcs_;
+	// Preference minus dual cost of each day-shift, indexed by k*nbShifts+s (filled at each update)
+	vector<double> dayShiftArcCosts_;
+
+	// Stores the arcs of the three types in their contiguous arrays (called once, after the arcs are created)
+	void initDayShiftArcs();
+	// Computes and updates the costs of the arcs of the given type whose day-shift cost changed
+	void updateDayShiftArcCosts(spp_day_shift_arcs& arcs);
+
+	// DATA -- INCREMENTAL UPDATE OF THE COSTS
+	//
+	// Costs of the arcs for the other nurses priced with this subproblem (those of the last nurse are in the graph)
+	map<LiveNurse*, spp_nurse_costs> nurseCosts_;
+	// Nurse, dual costs and forbidden day-shifts used at the last update of the arc costs
+	LiveNurse* pLastCostsNurse_;
+	State* pLastCostsStateIni_;
+	vector< vector<double> > lastWorkCosts_;									// Indexed by (day, shift) [shift 0 unused]
+	vector<double> lastStartWorkCosts_, lastEndWorkCosts_;
+	double lastWorkedWeekendCost_;
+	vector< vector<bool> > lastDayShiftStatus_;
+	// Costs changed since the last update: for each (day, shift), for the start / end of a rotation on each day, and for the short
+	// successions of size CDMin that end on each day
+	vector< vector<bool> > dayShiftCostChanged_;
+	vector<bool> startCostChanged_, endCostChanged_, shortSuccCostChanged_;
+	// Number of arcs whose cost has been updated / kept unchanged by the updates since the beginning of the last solve
+	int nArcsCostUpdated_, nArcsCostSkipped_;
+
+	// FUNCTIONS -- INCREMENTAL UPDATE OF THE COSTS
+	//
+	// Marks the costs that changed since the last update for the nurse (all of them if the nurse has never been priced
+	// with this subproblem), and stores the new ones
+	void markChangedCosts();
+	// Stores the costs of the arcs of the last nurse / restores those of the current nurse in the graph
+	void saveNurseCosts(spp_nurse_costs& nurseCosts);
+	void loadNurseCosts(const spp_nurse_costs& nurseCosts);
+
 	// DATA -- FORBIDDEN ARCS AND NODES
 	//
 	vector< vector<bool> > dayShiftStatus_;
+	DayShiftSet forbiddenDayShifts_;					// Same as dayShiftStatus_ (set if forbidden), compared with the next forbidden list
 	vector<bool> arcStatus_;
 	vector<bool> nodeStatus_;
+	vector<int> eliminatedArcs_;
+	vector<int> forbiddenArcs_;							// Arcs forbidden since the last reset of the forbidden arcs (some may have been authorized since)
+	vector<bool> isInForbiddenArcs_;					// For each arc, true if it is in forbiddenArcs_
+	vector<bool> isEliminatedArc_;						// For each arc, true if it is in eliminatedArcs_ (only set while forbidding)
 
 	// FUNCTIONS -- FORBIDDEN ARCS AND NODES
 	//
 	// Returns true if the succession succ starting on day k does not violate any forbidden day-shift
 	bool canSuccStartHere(vector<int> succ, int firstDay);
-	// Forbids some days / shifts
-	void forbid(set<pair<int,int> > forbiddenDayShifts);
+	// Forbids some days / shifts and the eliminated arcs (and authorizes the other ones again, unless keepForbidden is true)
+	void forbid(const DayShiftSet& forbiddenDayShifts, bool keepForbidden);
 	// Know if node / arc is forbidden
 	inline bool isArcForbidden(int a){return ! arcStatus_[a];}
 	inline bool isNodeForbidden(int v){return ! nodeStatus_[v];}
@@ -729,10 +1259,9 @@ protected:
 	void authorizeArc(int a);
 	void authorizeNode(int v);
 	void authorizeDayShift(int k, int s);
-	void resetAuthorizations();
 	// Updates the travel time of an arc / node
-	inline void updateTime(int a, int time){     boost::put( &Arc_Properties::time, g_, arcsDescriptors_[a], time );}
-	inline void updateLat(int v, int time){boost::put( &Vertex_Properties::lat, g_, v, time);}
+	inline void updateTime(int a, int time){     boost::put( &Arc_Properties::time, g_, arcsDescriptors_[a], time ); networkResources_.arcTime[a] = time;}
+	inline void updateLat(int v, int time){boost::put( &Vertex_Properties::lat, g_, v, time); networkResources_.nodeLat[v] = time;}
 	// Given an arc, returns the normal travel time (i.e. travel time when authorized)
 	int normalTravelTime(int a);
 	// Test for random forbidden day-shift
@@ -807,6 +1336,49 @@ protected:
 	  Label_Allocator /*la*/,
 	  Visitor vis );
 
+	//----------------------------------------------------------------
+	//
+	// Day-bucketed labeling algorithm
+	// (the network is acyclic: the nodes are treated in topological
+	// order, so that no priority queue is needed)
+	//
+	//----------------------------------------------------------------
+
+	// Immutable topology of the network (computed once, with the graph), usually shared with the other subproblems of the contract.
+	// It is owned by the subproblem only if it has not been given to the constructor
+	const spp_csr_topology* pTopology_;
+	spp_csr_topology* pOwnedTopology_;
+	// Costs, times and latest arrival times of the current solve (kept equal to those of the graph by updateCost, updateTime, updateLat)
+	spp_network_resources networkResources_;
+	// For each node, the non-dominated labels that reached it (capacity kept between two solves)
+	vector<spp_label_bucket> labelsAtNode_;
+	// For each node, the non-dominated backward labels of the bidirectional algorithm
+	vector<spp_backward_bucket> backwardLabelsAtNode_;
+
+	// For each node, lower bound on the cost of the paths to the sinks of the current solve (time relaxed)
+	vector<double> completionBound_;
+
+	// Builds the CSR topology in the given one if it is empty (in a new one if none is given), and the resource arrays from the graph
+	void initCsrTopology(spp_csr_topology* pTopology);
+	// Backward pass over the network: computes the completion bound of each node for the given resources and sinks
+	// (+infinity if no sink can be reached). The forbidden arcs are used only if useForbiddenArcs is true
+	void computeCompletionBounds(const spp_network_resources& resources, const vector<int>& sinks, vector<double>& completionBound,
+			bool useForbiddenArcs = false) const;
+	// Solves the SPPRC from the source to all given sinks and returns the Pareto-optimal paths (same format as boost).
+	// Only reads the topology and the given resources: the labels are stored in the given buckets. The labels whose cost
+	// plus completion bound is not lower than maxCost, or whose time exceeds maxTime, are dropped, and at most labelBudget
+	// labels are kept at each node (all of them if labelBudget is 0)
+	void r_c_shortest_paths_day_buckets(const spp_network_resources& resources, const vector<double>& completionBound, double maxCost,
+			int maxTime, int labelBudget, vector<spp_label_bucket>& labelsAtNode, const vector<int>& sinks,
+			vector< vector< boost::graph_traits<Graph>::edge_descriptor > >& pareto_optimal_solutions,
+			vector<spp_spptw_res_cont>& pareto_optimal_resource_containers, long& nbLabels) const;
+	// Same problem and same Pareto-optimal paths, solved by labeling forward from the source on the days before midDay and
+	// backward from all the sinks on the following days. The labels are joined on the arcs that enter midDay
+	void r_c_shortest_paths_bidirectional(const spp_network_resources& resources, const vector<double>& completionBound, double maxCost,
+			int maxTime, int labelBudget, vector<spp_label_bucket>& forwardLabelsAtNode, vector<spp_backward_bucket>& backwardLabelsAtNode, const vector<int>& sinks, int midDay,
+			vector< vector< boost::graph_traits<Graph>::edge_descriptor > >& pareto_optimal_solutions,
+			vector<spp_spptw_res_cont>& pareto_optimal_resource_containers, long& nbLabels) const;
+
 
 
 
@@ -827,6 +1399,10 @@ public:
 	inline int nPaths(){return nPaths_;}
 	inline int nLongFound(){return nLongFound_;}
 	inline int nVeryShortFound(){return nVeryShortFound_;}
+	inline size_t peakLabelMemory(){return peakLabelMemory_;}
+	inline long nbLabels(){return nbLabels_;}
+	inline int nArcsCostUpdated(){return nArcsCostUpdated_;}
+	inline int nArcsCostSkipped(){return nArcsCostSkipped_;}
 
 	// Print functions.
 	//
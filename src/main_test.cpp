@@ -24,7 +24,7 @@
 
 //initialize the counter of object
 unsigned int MyObject::s_count = 0;
-unsigned int Rotation::s_count = 0;
+std::atomic<unsigned int> Rotation::s_count(0);
 
 // Function for testing parts of the code (Antoine)
 void testFunction_Antoine(){
@@ -55,6 +55,8 @@ void testFunction_Antoine(){
 
    Scenario* pScen = initializeMultipleWeeks(data, inst, 0, {0});
 
+   testSpprcBidirectional(pScen, 100);
+
    Solver* pSolver = setSolverWithInputAlgorithm(pScen, GENCOL);
    pSolver->solve(optParam);
 
@@ -908,3 +910,34 @@ void testCbc(Scenario* pScen) {
   Tools::LogOutput outStream(outFile);
   outStream << pMPCbc->solutionToString();
 }
+
+/****************************************
+* Test the bidirectional labeling of the subproblems: it must find the same
+* Pareto-fronts as the day-bucketed one for the first nurse of each contract
+*****************************************/
+bool testSpprcBidirectional(Scenario* pScen, int nTests) {
+
+	Demand* pDemand = pScen->pWeekDemand();
+	Preferences* pPref = pScen->pWeekPreferences();
+	vector<State>* pStateIni = pScen->pInitialState();
+	int nbDays = pDemand->nbDays_, nbShifts = pScen->nbShifts_-1;
+
+	// null dual costs first (the subproblem draws the random ones)
+	vector<double> workCosts(nbDays*nbShifts, 0), startWorkCosts(nbDays, 0), endWorkCosts(nbDays, 0);
+	DualCosts costs(workCosts.data(), nbShifts, 0, startWorkCosts.data(), endWorkCosts.data(), 0);
+
+	bool equivalent = true;
+	set<const Contract*> testedContracts;
+	for(int i=0; i<pScen->nbNurses_; i++){
+		const Nurse& nurse = pScen->theNurses_[i];
+		if(!testedContracts.insert(nurse.pContract_).second) continue;
+		LiveNurse liveNurse(nurse, pScen, nbDays, pDemand->firstDay_, &(*pStateIni)[i], &(pPref->wishesOff_[i]));
+		SubProblem subProblem(pScen, nbDays, nurse.pContract_, pStateIni);
+		if(!subProblem.testSpprcBidirectional(&liveNurse, &costs, nTests))
+			equivalent = false;
+	}
+
+	std::cout << "# Bidirectional SPPRC: " << (equivalent ? "same" : "DIFFERENT") << " Pareto-fronts as the day-bucketed one for "
+			<< testedContracts.size() << " contracts and " << nTests << " random costs" << std::endl;
+	return equivalent;
+}
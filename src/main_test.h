@@ -97,3 +97,7 @@ void testRandomDemandGenerator(int nbDemands,string logFile, Scenario* pScen);
 
 // Test the cbc modeler
 void testCbc(Scenario* pScen);
+
+// Test the bidirectional labeling of the subproblems against the day-bucketed one (same Pareto-fronts at all the sinks)
+// for the first nurse of each contract, with null dual costs and nTests random ones
+bool testSpprcBidirectional(Scenario* pScen, int nTests);